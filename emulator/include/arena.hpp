@@ -0,0 +1,80 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vc::util {
+
+    /*
+     * Bump allocator that places objects next to each other in large chunks.
+     * Objects live until the arena itself gets destroyed, at which point they are destructed in reverse creation order.
+     */
+    class Arena {
+    public:
+        explicit Arena(size_t chunkSize = 64 * 1024) : chunkSize(chunkSize) { }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() {
+            for (auto it = this->destructors.rbegin(); it != this->destructors.rend(); ++it)
+                it->destroy(it->object);
+        }
+
+        template<typename T, typename ... Args>
+        T* create(Args&&... args) {
+            auto object = new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                this->destructors.push_back({ object, [](void *ptr) { static_cast<T*>(ptr)->~T(); } });
+
+            return object;
+        }
+
+        [[nodiscard]]
+        void* allocate(size_t size, size_t alignment) {
+            auto address = alignUp(this->current, alignment);
+
+            if (address + size > this->end) {
+                auto newChunkSize = std::max(this->chunkSize, size + alignment);
+                this->chunks.emplace_back(new std::byte[newChunkSize]);
+
+                this->current = reinterpret_cast<uintptr_t>(this->chunks.back().get());
+                this->end = this->current + newChunkSize;
+                address = alignUp(this->current, alignment);
+            }
+
+            this->current = address + size;
+            return reinterpret_cast<void*>(address);
+        }
+
+        [[nodiscard]]
+        size_t getChunkCount() const {
+            return this->chunks.size();
+        }
+
+    private:
+        struct Destructor {
+            void *object;
+            void (*destroy)(void*);
+        };
+
+        constexpr static uintptr_t alignUp(uintptr_t address, size_t alignment) {
+            return (address + alignment - 1) & ~uintptr_t(alignment - 1);
+        }
+
+        size_t chunkSize;
+        uintptr_t current = 0, end = 0;
+        std::vector<std::unique_ptr<std::byte[]>> chunks;
+        std::vector<Destructor> destructors;
+    };
+
+}
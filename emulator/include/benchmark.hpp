@@ -0,0 +1,108 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+#include <unistd.h>
+
+/*
+ * Measurement helpers shared by the benchmark executables.
+ * Replaces the global allocation functions to count every heap allocation of the process, so it has to be included by exactly one translation unit per executable
+ */
+namespace vc::bench {
+
+    inline std::atomic<u64> allocationCount = 0, allocatedBytes = 0;
+
+    /* Number of heap allocations since the process started */
+    [[nodiscard]]
+    inline u64 getAllocationCount() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    inline u64 getAllocatedBytes() {
+        return allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    /* Bytes currently handed out by the heap, unlike the resident set size this goes down again once something gets freed */
+    [[nodiscard]]
+    inline u64 getHeapUsage() {
+        return mallinfo2().uordblks;
+    }
+
+    /* Resident set size of the process, includes the anonymous mappings backing guest memories */
+    [[nodiscard]]
+    inline u64 getResidentMemory() {
+        FILE *file = fopen("/proc/self/statm", "r");
+        if (file == nullptr)
+            return 0;
+
+        unsigned long long size = 0, resident = 0;
+        if (fscanf(file, "%llu %llu", &size, &resident) != 2)
+            resident = 0;
+        fclose(file);
+
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+}
+
+namespace vc::bench::impl {
+
+    /* Kept out of line, once inlined into a caller GCC can't tell this free apart from one mismatching the operator new the pointer came from */
+    [[gnu::noinline]]
+    inline void* allocate(size_t size, size_t alignment) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+        size = std::max<size_t>(size, 1);
+        if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return std::malloc(size);
+        else
+            return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    [[gnu::noinline]]
+    inline void deallocate(void *pointer) noexcept {
+        std::free(pointer);
+    }
+
+    inline void* allocateOrThrow(size_t size, size_t alignment) {
+        if (auto pointer = allocate(size, alignment); pointer != nullptr)
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+
+}
+
+/* Every replaceable allocation function is replaced, so no allocation goes by uncounted */
+void* operator new(size_t size) { return vc::bench::impl::allocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return vc::bench::impl::allocateOrThrow(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return vc::bench::impl::allocateOrThrow(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return vc::bench::impl::allocateOrThrow(size, size_t(alignment)); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return vc::bench::impl::allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return vc::bench::impl::allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return vc::bench::impl::allocate(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return vc::bench::impl::allocate(size, size_t(alignment)); }
+
+void operator delete(void *pointer) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete(void *pointer, size_t) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept { vc::bench::impl::deallocate(pointer); }
+
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { vc::bench::impl::deallocate(pointer); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { vc::bench::impl::deallocate(pointer); }
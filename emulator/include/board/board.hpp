@@ -1,53 +1,377 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <concepts>
-#include <list>
+#include <condition_variable>
+#include <functional>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
+
+#include <arena.hpp>
 
 #include <devices/device.hpp>
+#include <board/geometry.hpp>
 #include <board/track.hpp>
-
-#include <imgui.h>
-#define IMGUI_DEFINE_MATH_OPERATORS
-#include <imgui_internal.h>
+#include <board/netlist.hpp>
+#include <board/scheduler.hpp>
+#include <board/input_log.hpp>
+#include <board/snapshot.hpp>
 
 namespace vc::pcb {
 
     class Board {
     public:
-        explicit Board(std::string_view name, ImVec2 size) : boardName(name), dimensions(size) { }
+        explicit Board(std::string_view name, Vec2 size) : boardName(name), dimensions(size) {
+            this->scheduler.setWindowCallback([this] { this->synchronize(); });
+        }
         virtual ~Board() {
             this->powerDown();
+        }
 
-            for (auto &device : this->devices)
-                delete device;
+        /*
+         * Resolves all name based connections into direct track handles and levelizes the netlist so a single pass in evaluation order settles all combinational logic.
+         * Runs once before the board is powered up the first time
+         */
+        void elaborate() {
+            if (this->elaborated) return;
+
+            const auto &deviceList = this->devices;
+            std::map<Connectable*, u32> nodeIds;
+
+            for (u32 i = 0; i < deviceList.size(); i++) {
+                if (auto connectable = dynamic_cast<Connectable*>(deviceList[i]); connectable != nullptr) {
+                    connectable->elaborate();
+                    nodeIds[connectable] = i;
+                }
+            }
+
+            Netlist netlist(deviceList.size());
+            for (auto &track : this->tracks) {
+                auto [from, to] = track->getEndpoints();
+                if (track->getDirection() == Direction::MISO)
+                    std::swap(from, to);
+
+                netlist.connect(nodeIds.at(from), nodeIds.at(to));
+            }
+            netlist.levelize();
 
-            for (auto &[name, track] : this->tracks)
-                delete track;
+            if (netlist.getFeedbackEdgeCount() > 0)
+                log::warn("Board '{}' contains {} feedback tracks, treating them as clocked boundaries", this->boardName, netlist.getFeedbackEdgeCount());
+
+            std::vector<u32> order(deviceList.size());
+            for (u32 i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&levels = netlist.getLevels()](u32 a, u32 b) {
+                return levels[a] < levels[b];
+            });
+
+            this->evaluationOrder.clear();
+            for (auto i : order)
+                this->evaluationOrder.push_back(deviceList[i]);
+
+            this->partitionDevices(nodeIds);
+
+            this->elaborated = true;
         }
 
         void powerUp() {
+            this->start();
+            this->run();
+        }
+
+        /* Gets the board ready to run from the beginning. A board that got restored from a snapshot continues from there instead of starting over */
+        void start() {
+            if (!std::exchange(this->restored, false))
+                this->reset();
+        }
+
+        /* Brings all devices back into their initial state, memories back into their golden state if one got captured. Only called while the board isn't running */
+        void reset() {
+            this->elaborate();
+
+            for (auto &device : this->evaluationOrder)
+                device->reset();
+
+            /* Values still in flight from the previous run, no matter if they would have crossed a partition or not */
+            for (auto &track : this->tracks)
+                track->clear();
+
+            this->scheduler.reset();
+            this->startInputLogs();
+        }
+
+        /*
+         * Simulates on the calling thread until power gets cut or no device has any work left.
+         * Unlike powerUp() it continues from wherever the board currently is, so a board that got powered down at a window boundary can be run again to pick up from there
+         */
+        void run() {
+            this->elaborate();
             this->hasPower = true;
+            this->restored = false;
+
+            this->publishState();
+
+            this->running = true;
+            this->scheduler.run(this->hasPower);
+            this->running = false;
+
+            this->publishState();
+        }
+
+        [[nodiscard]]
+        bool isRunning() const {
+            return this->running;
+        }
+
+        /* Stops all partitions at the next window boundary until resume() gets called, e.g. to let a debugger inspect the board */
+        void requestPause() {
+            this->pauseRequested = true;
+        }
+
+        void resume() {
+            {
+                std::scoped_lock lock(this->pauseMutex);
+                this->pauseRequested = false;
+            }
+
+            this->pauseCondition.notify_all();
+        }
+
+        [[nodiscard]]
+        bool isPaused() const {
+            return this->paused;
+        }
+
+        /* Incremented every time the board enters the paused state */
+        [[nodiscard]]
+        u64 getPauseCount() const {
+            return this->pauseCount;
+        }
+
+        /* Every input applied since the last power up, may be called while the board is running */
+        [[nodiscard]]
+        InputLog getRecordedInputs() {
+            std::scoped_lock lock(this->inputLogMutex);
+            return this->recordedInputs;
+        }
+
+        /* Replays the log on every following power up. Live inputs get ignored until the end of the log is reached */
+        void replayInputs(InputLog log) {
+            std::scoped_lock lock(this->inputLogMutex);
+            this->replayLog = std::move(log);
+        }
 
+        void stopReplay() {
+            std::scoped_lock lock(this->inputLogMutex);
+            this->replayLog.reset();
+        }
+
+        [[nodiscard]]
+        bool isReplaying() const {
+            return this->replaying;
+        }
+
+        /* Replays the inputs applied after the given point in time once more, used after the board's state got rewound to it */
+        void rewindInputs(u64 time) {
+            std::scoped_lock lock(this->inputLogMutex);
+
+            this->activeReplay = this->recordedInputs;
+            this->recordedInputs.dropAfter(time);
+            this->replayReader.emplace(this->activeReplay);
+
+            while (true) {
+                const auto &entry = this->replayReader->peek();
+                if (!entry.has_value() || entry->time > time)
+                    break;
+
+                this->replayReader->pop();
+            }
+
+            this->replaying = this->replayReader->peek().has_value();
+        }
+
+        /* Forgets inputs older than the given point in time, used once no history reaches back that far anymore */
+        void dropInputsBefore(u64 time) {
+            std::scoped_lock lock(this->inputLogMutex);
+            this->recordedInputs.dropBefore(time);
+        }
+
+        /* Gets called at every window boundary on the simulation side, after all inputs got applied */
+        void setWindowListener(std::function<void()> listener) {
+            this->windowListener = std::move(listener);
+        }
+
+        /* Complete simulation state apart from the contents of memories. Only called while the board is paused */
+        void saveState(util::StateWriter &state) {
+            this->scheduler.saveState(state);
+            for (auto &track : this->tracks)
+                track->saveState(state);
             for (auto &device : this->devices)
-                device->reset();
+                device->saveState(state);
+        }
 
-            bool doneWork;
-            do {
-                doneWork = false;
-                for (auto &device : this->devices) {
-                    if (device->needsUpdate()) {
-                        device->tick();
-                        doneWork = true;
-                    }
-                }
-            } while (doneWork && this->hasPower);
+        void loadState(util::StateReader &state) {
+            this->scheduler.loadState(state);
+            for (auto &track : this->tracks)
+                track->loadState(state);
+            for (auto &device : this->devices)
+                device->loadState(state);
+
+            this->publishState();
+        }
+
+        /*
+         * Makes every following power up start with the memories' current contents, e.g. right after firmware got loaded, everything else still gets reset.
+         * Memories restore just the pages that got written since, which keeps reusing a board for many short runs cheap. Only called while the board isn't running
+         */
+        void captureGoldenState() {
+            for (auto &device : this->devices)
+                device->captureGoldenState();
+
+            this->goldenCaptured = true;
+        }
+
+        [[nodiscard]]
+        bool hasGoldenState() const {
+            return this->goldenCaptured;
+        }
+
+        /* Captures the whole machine. Only called while the board is paused or isn't running */
+        [[nodiscard]]
+        Snapshot snapshot() {
+            util::StateWriter state(true);
+            this->saveState(state);
+
+            std::scoped_lock lock(this->inputLogMutex);
+            return { this->getVirtualTime(), this->scheduler.getLookahead(), std::move(state.getData()), std::move(state.getImages()), this->recordedInputs };
+        }
+
+        /*
+         * Brings the board into the state of a snapshot taken from a board of the same type. Only called while the board is paused or isn't running.
+         * A paused board continues from there once it gets resumed, one that isn't running continues from there on its next power up
+         */
+        bool restore(const Snapshot &snapshot) {
+            if (!this->elaborated)
+                this->setLookahead(snapshot.lookahead);
+            this->elaborate();
+
+            if (snapshot.lookahead != this->scheduler.getLookahead()) {
+                log::error("Snapshot was taken with a lookahead of {} ticks but the board uses {}, not restoring it", snapshot.lookahead, this->scheduler.getLookahead());
+                return false;
+            }
+
+            util::StateReader state(snapshot.state, snapshot.images);
+            this->loadState(state);
+
+            {
+                std::scoped_lock lock(this->inputLogMutex);
+                this->recordedInputs = snapshot.inputs;
+                this->replayReader.reset();
+                this->replaying = false;
+            }
+
+            this->restored = !this->running;
+            return true;
+        }
+
+        /*
+         * Creates independent boards restored from the snapshot, ready to be powered up.
+         * They share all memory pages with each other until they write to them, so forking a booted board is a lot cheaper than booting it again
+         */
+        template<std::derived_from<Board> T>
+        [[nodiscard]]
+        static std::vector<std::unique_ptr<T>> fork(const Snapshot &snapshot, u32 count) {
+            std::vector<std::unique_ptr<T>> children;
+
+            for (u32 i = 0; i < count; i++) {
+                auto child = std::make_unique<T>();
+                if (!child->restore(snapshot))
+                    break;
+
+                children.push_back(std::move(child));
+            }
+
+            return children;
+        }
+
+        /* Injects an input event from the host. May be called from any thread, also while the UI posts the devices' own inputs */
+        void postInput(u32 device, u32 channel, u64 value) {
+            this->inputQueue.push({ device, channel, value });
+        }
+
+        /* Number of host threads the board's partitions get distributed on. Doesn't influence the simulation result */
+        void setWorkerCount(u32 count) {
+            this->scheduler.setWorkerCount(count);
+        }
+
+        /* Latency in ticks of tracks crossing between partitions and thereby the number of ticks partitions run without synchronizing. Has to be set before the board gets elaborated */
+        void setLookahead(u64 ticks) {
+            this->scheduler.setLookahead(ticks);
+        }
+
+        [[nodiscard]]
+        u64 getVirtualTime() const {
+            return this->scheduler.getTime();
+        }
+
+        /* Nominal frequency of one simulation tick. Only used to relate virtual time to wall clock time */
+        void setTickFrequency(u64 hertz) {
+            this->tickFrequency = std::max<u64>(1, hertz);
+        }
+
+        [[nodiscard]]
+        u64 getTickFrequency() const {
+            return this->tickFrequency;
+        }
+
+        /* Total number of device ticks executed, updated whenever a new state snapshot gets published */
+        [[nodiscard]]
+        u64 getDeviceTicks() const {
+            return this->deviceTicks.load(std::memory_order_relaxed);
+        }
+
+        /* Total number of transfers on the board's tracks: bytes pushed into buffered ones plus value changes on unbuffered ones */
+        [[nodiscard]]
+        u64 getTrackTraffic() const {
+            u64 transfers = 0;
+            for (const auto &track : this->tracks)
+                transfers += track->getChangeCount();
+
+            return transfers;
+        }
+
+        [[nodiscard]]
+        const std::vector<dev::Device*>& getDevices() const {
+            return this->devices;
+        }
+
+        /* Upper bound for how often the simulation hands a new state snapshot over to the UI */
+        void setPublishInterval(std::chrono::microseconds interval) {
+            this->publishInterval = interval;
+        }
+
+        /* Incremented every time a published state snapshot changed what's drawn on the board */
+        [[nodiscard]]
+        u64 getStateVersion() const {
+            return this->stateVersion.load(std::memory_order_acquire);
         }
 
         void powerDown() {
-            this->hasPower = false;
+            {
+                std::scoped_lock lock(this->pauseMutex);
+                this->hasPower = false;
+            }
+
+            this->pauseCondition.notify_all();
         }
 
         [[nodiscard]]
@@ -55,69 +379,288 @@ namespace vc::pcb {
             return this->boardName;
         }
 
-        virtual void draw(ImDrawList *drawList) {
-            drawList->AddRectFilled(getPosition(), getPosition() + getDimensions(), ImColor(0x09, 0x91, 0x32, 0xFF));
+        [[nodiscard]]
+        const std::vector<Connectable*>& getConnectables() const {
+            return this->connectables;
+        }
 
-            for (auto &[name, track] : this->tracks) {
-                auto [from, to] = track->getEndpoints();
+        [[nodiscard]]
+        const std::vector<pcb::Track*>& getTracks() const {
+            return this->tracks;
+        }
 
-                auto startPos = getPosition() + from->getPosition() + from->getSize() / 2;
-                auto endPos = getPosition() + to->getPosition() + to->getSize() / 2;
-                auto middlePos = startPos.x - getPosition().x > startPos.y - getPosition().y ? ImVec2(startPos.x, endPos.y) : ImVec2(endPos.x, startPos.y);
+        [[nodiscard]]
+        Vec2 getDimensions() const {
+            return this->dimensions;
+        }
+
+    private:
+        /* Runs between two windows of virtual time while all partitions are stopped */
+        void synchronize() {
+            if (this->replaying) {
+                while (true) {
+                    const auto &entry = this->replayReader->peek();
+                    if (!entry.has_value() || entry->time > this->getVirtualTime())
+                        break;
+
+                    this->applyInput(entry->event);
+                    this->replayReader->pop();
+                }
 
-                drawList->AddLine(startPos, middlePos, ImColor(0x19, 0xC1, 0x62, 0xFF), 3);
-                drawList->AddLine(middlePos, endPos, ImColor(0x19, 0xC1, 0x62, 0xFF), 3);
+                if (!this->replayReader->peek().has_value())
+                    this->replaying = false;
+
+                /* Live inputs would make the run diverge from the recording */
+                this->inputQueue.clear();
             }
-                
-                
-            for (auto &device : this->devices) {
-                if (auto connectable = dynamic_cast<Connectable*>(device); connectable != nullptr) {
-                    connectable->draw(getPosition(), drawList);
+
+            while (auto event = this->inputQueue.pop())
+                this->applyInput(*event);
+
+            if (this->windowListener)
+                this->windowListener();
+
+            if (this->pauseRequested.load(std::memory_order_relaxed) || this->devicesWantPause())
+                this->waitWhilePaused();
+
+            if (std::chrono::steady_clock::now() - this->lastPublish >= this->publishInterval)
+                this->publishState();
+        }
+
+        void applyInput(const InputEvent &event) {
+            if (event.device >= this->devices.size())
+                return;
+
+            this->devices[event.device]->applyInput(event.channel, event.value);
+
+            std::scoped_lock lock(this->inputLogMutex);
+            this->recordedInputs.append(this->getVirtualTime(), event);
+        }
+
+        void startInputLogs() {
+            std::scoped_lock lock(this->inputLogMutex);
+
+            this->recordedInputs = InputLog(this->scheduler.getLookahead());
+
+            this->replaying = false;
+            if (this->replayLog.has_value()) {
+                if (this->replayLog->getLookahead() == this->scheduler.getLookahead()) {
+                    this->activeReplay = *this->replayLog;
+                    this->replayReader.emplace(this->activeReplay);
+                    this->replaying = true;
+                } else {
+                    log::error("Input log was recorded with a lookahead of {} ticks but the board uses {}, not replaying it", this->replayLog->getLookahead(), this->scheduler.getLookahead());
                 }
             }
         }
 
         [[nodiscard]]
-        ImVec2 getPosition() const {
-            return this->position;
+        bool devicesWantPause() const {
+            return std::any_of(this->devices.begin(), this->devices.end(), [](dev::Device *device) { return device->wantsPause(); });
         }
 
-        void setPosition(ImVec2 pos) {
-            this->position = pos;
+        void waitWhilePaused() {
+            this->publishState();
+
+            std::unique_lock lock(this->pauseMutex);
+            this->paused = true;
+            this->pauseCount++;
+
+            this->pauseCondition.wait(lock, [this] {
+                return !this->hasPower || (!this->pauseRequested && !this->devicesWantPause());
+            });
+
+            this->paused = false;
         }
 
-        [[nodiscard]]
-        ImVec2 getDimensions() const {
-            return this->dimensions;
+        void publishState() {
+            bool changed = false;
+            for (auto &device : this->devices)
+                changed |= device->publishState();
+
+            u64 ticks = 0;
+            for (const auto &partition : this->scheduler.getPartitions())
+                ticks += partition.ticks.get();
+            this->deviceTicks.store(ticks, std::memory_order_relaxed);
+
+            this->lastPublish = std::chrono::steady_clock::now();
+            if (changed)
+                this->stateVersion.fetch_add(1, std::memory_order_release);
+        }
+
+        /*
+         * Every clock domain device gets its own partition. All other devices are clustered by the tracks between them,
+         * a cluster that only talks to a single clock domain joins that domain's partition, all others become partitions of their own.
+         * Tracks crossing partitions are turned into channels
+         */
+        void partitionDevices(const std::map<Connectable*, u32> &nodeIds) {
+            const auto &deviceList = this->devices;
+            constexpr static u32 NoDomain = std::numeric_limits<u32>::max();
+
+            std::vector<u32> cluster(deviceList.size());
+            for (u32 i = 0; i < cluster.size(); i++)
+                cluster[i] = i;
+
+            auto findCluster = [&](u32 node) {
+                while (cluster[node] != node)
+                    node = cluster[node] = cluster[cluster[node]];
+                return node;
+            };
+
+            for (auto &track : this->tracks) {
+                auto [from, to] = track->getEndpoints();
+                auto a = nodeIds.at(from), b = nodeIds.at(to);
+
+                if (!deviceList[a]->isClockDomain() && !deviceList[b]->isClockDomain())
+                    cluster[findCluster(a)] = findCluster(b);
+            }
+
+            /* Find the one clock domain each peripheral cluster talks to, if there's more than one the cluster stays on its own */
+            std::map<u32, u32> clusterDomain;
+            for (auto &track : this->tracks) {
+                auto [from, to] = track->getEndpoints();
+                auto a = nodeIds.at(from), b = nodeIds.at(to);
+
+                if (deviceList[a]->isClockDomain() == deviceList[b]->isClockDomain())
+                    continue;
+                if (deviceList[a]->isClockDomain())
+                    std::swap(a, b);
+
+                auto [it, inserted] = clusterDomain.insert({ findCluster(a), b });
+                if (!inserted && it->second != b)
+                    it->second = NoDomain;
+            }
+
+            std::vector<u32> partitionOf(deviceList.size(), NoDomain);
+            std::map<u32, u32> partitionOfCluster;
+            u32 partitionCount = 0;
+
+            for (u32 i = 0; i < deviceList.size(); i++) {
+                if (deviceList[i]->isClockDomain())
+                    partitionOf[i] = partitionCount++;
+            }
+
+            /* Peripherals that don't talk to any clock domain all share one partition */
+            u32 floatingPartition = NoDomain;
+            for (u32 i = 0; i < deviceList.size(); i++) {
+                if (deviceList[i]->isClockDomain()) continue;
+
+                auto root = findCluster(i);
+                auto domain = clusterDomain.find(root);
+
+                if (domain == clusterDomain.end()) {
+                    if (floatingPartition == NoDomain)
+                        floatingPartition = partitionCount++;
+                    partitionOf[i] = floatingPartition;
+                } else if (domain->second != NoDomain) {
+                    partitionOf[i] = partitionOf[domain->second];
+                } else {
+                    auto [it, inserted] = partitionOfCluster.insert({ root, partitionCount });
+                    if (inserted)
+                        partitionCount++;
+                    partitionOf[i] = it->second;
+                }
+            }
+
+            auto &partitions = this->scheduler.getPartitions();
+            partitions.clear();
+            partitions.resize(partitionCount);
+
+            std::map<dev::Device*, u32> deviceIds;
+            for (u32 i = 0; i < deviceList.size(); i++)
+                deviceIds[deviceList[i]] = i;
+
+            for (auto &device : this->evaluationOrder)
+                partitions[partitionOf[deviceIds[device]]].devices.push_back(device);
+
+            for (auto &track : this->tracks) {
+                auto [from, to] = track->getEndpoints();
+                if (track->getDirection() == Direction::MISO)
+                    std::swap(from, to);
+
+                auto writer = partitionOf[nodeIds.at(from)], reader = partitionOf[nodeIds.at(to)];
+                if (writer == reader) continue;
+
+                const auto lookahead = this->scheduler.getLookahead();
+                track->makeChannel(&partitions[writer].time, &partitions[reader].time, lookahead, std::max<size_t>(ChannelCapacity, lookahead * 2));
+                this->scheduler.addChannel(track);
+            }
         }
 
     protected:
         template<std::derived_from<dev::Device> T, typename ...Args>
         auto& createDevice(Args&&... args) {
-            auto device = new T(std::forward<Args>(args)...);
+            auto device = this->arena.create<T>(std::forward<Args>(args)...);
             this->devices.push_back(device);
 
+            if constexpr (std::derived_from<T, Connectable>) {
+                this->connectables.push_back(device);
+                device->board = this;
+                device->inputQueue = &this->inputQueue;
+                device->deviceIndex = this->devices.size() - 1;
+            }
+
             return *device;
         }
 
-        void createTrack(Direction direction, const std::string &name, pcb::Connectable &from, pcb::Connectable &to, bool buffered = false) {
-            if (this->tracks.contains(name)) return;
+        void createTrack(Direction direction, const std::string &name, pcb::Connectable &from, pcb::Connectable &to, bool buffered = false, TrackBuffer bufferConfig = { }) {
+            if (this->trackIds.contains(name)) return;
+
+            if (from.board != this || to.board != this) {
+                log::error("Track '{}' connects a device that isn't part of board '{}'", name, this->boardName);
+                return;
+            }
 
-            auto track = new Track(direction, buffered, &from, &to);
-            this->tracks.insert({ name, track });
+            auto track = this->arena.create<Track>(TrackId(this->tracks.size()), direction, buffered, &from, &to, bufferConfig);
+            this->tracks.push_back(track);
+            this->trackIds.insert({ name, track->getId() });
 
             from.linkTrack(name, track);
             to.linkTrack(name, track);
         }
 
     private:
-        bool hasPower = false;
+        constexpr static inline size_t ChannelCapacity = 4096;
+
+        std::atomic<bool> hasPower = false, running = false;
+        bool restored = false, goldenCaptured = false;
+
+        std::mutex pauseMutex;
+        std::condition_variable pauseCondition;
+        std::atomic<bool> pauseRequested = false, paused = false;
+        std::atomic<u64> pauseCount = 0;
+        bool elaborated = false;
         std::string boardName;
-        std::list<dev::Device*> devices;
-        std::map<std::string, pcb::Track*> tracks;
+        /* Devices and tracks are placed next to each other in creation order and all get destroyed together with the board */
+        util::Arena arena;
+        std::vector<dev::Device*> devices;
+        std::vector<dev::Device*> evaluationOrder;
+        Scheduler scheduler;
+
+        std::vector<Connectable*> connectables;
+
+        InputQueue inputQueue = InputQueue(1024);
+
+        std::mutex inputLogMutex;
+        InputLog recordedInputs;
+        std::optional<InputLog> replayLog;
+
+        /* Only touched by the simulation, replayLog may get replaced while the board is running */
+        InputLog activeReplay;
+        std::optional<InputLog::Reader> replayReader;
+        std::atomic<bool> replaying = false;
+
+        std::function<void()> windowListener;
+
+        std::atomic<u64> stateVersion = 0;
+        std::atomic<u64> deviceTicks = 0;
+        u64 tickFrequency = 1'000'000;
+        std::chrono::microseconds publishInterval = std::chrono::milliseconds(16);
+        std::chrono::steady_clock::time_point lastPublish;
+        std::vector<pcb::Track*> tracks;
+        std::map<std::string, TrackId, std::less<>> trackIds;
 
-        ImVec2 position;
-        ImVec2 dimensions;
+        Vec2 dimensions;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <board/board.hpp>
+
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/mmio/memory.hpp>
+#include <devices/cpu/core/mmio/uart.hpp>
+#include <devices/cpu/core/mmio/gpio.hpp>
+#include <devices/cpu/core/mmio/test_finisher.hpp>
+#include <devices/cpu/core/mmio/cycle_counter.hpp>
+
+#include <devices/serial_console.hpp>
+
+namespace vc::pcb {
+
+    /* Same memory map as the test board, with the UART going to a console, a test finisher to end runs from the guest and a cycle counter for it to measure itself */
+    class HeadlessBoard : public Board {
+    public:
+        HeadlessBoard() : Board("Headless Board", { 200, 200 }),
+        cpu(createDevice<dev::CPUDevice>(1, Vec2{ 50, 50 })),
+        console(createDevice<dev::SerialConsole>(Vec2{ 150, 150 })),
+
+        cpuFlash(0x0000'0000, 1_MiB),
+        cpuFinisher(0x0010'0000),
+        cpuCycles(0x0010'1000, cpu.getCore(0)),
+        cpuRam(0x1000'0000, 2_MiB),
+        cpuUartA(0x5000'0000),
+        cpuGpioA(0x6000'0000) {
+            auto &cpuAddressSpace = cpu.getAddressSpace();
+
+            cpu.attachToPin(0, cpuUartA.txPin);
+
+            cpuAddressSpace.addDevice(cpuFlash);
+            cpuAddressSpace.addDevice(cpuFinisher);
+            cpuAddressSpace.addDevice(cpuCycles);
+            cpuAddressSpace.addDevice(cpuRam);
+            cpuAddressSpace.addDevice(cpuUartA);
+            cpuAddressSpace.addDevice(cpuGpioA);
+
+            this->createTrack(Direction::MOSI, "uarta_tx", cpu, console, true);
+            cpu.attachPinToTrack(0, "uarta_tx");
+        }
+
+        dev::CPUDevice &cpu;
+        dev::SerialConsole &console;
+
+        dev::cpu::mmio::Memory cpuFlash;
+        dev::cpu::mmio::TestFinisher cpuFinisher;
+        dev::cpu::mmio::CycleCounter cpuCycles;
+        dev::cpu::mmio::Memory cpuRam;
+        dev::cpu::mmio::UART cpuUartA;
+        dev::cpu::mmio::GPIO cpuGpioA;
+    };
+
+}
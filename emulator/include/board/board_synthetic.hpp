@@ -0,0 +1,74 @@
+#pragma once
+
+#include <board/board.hpp>
+
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/mmio/memory.hpp>
+#include <devices/cpu/core/mmio/gpio.hpp>
+
+#include <devices/button.hpp>
+#include <devices/led.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vc::pcb {
+
+    struct SyntheticBoardConfig {
+        u32 devices = 2;        /* Buttons and LEDs next to the CPU, alternating */
+        u32 tracks = 1;         /* Spread round robin over button to LED pairs */
+        u32 peripherals = 0;    /* GPIO blocks on the CPU's bus besides flash and RAM */
+    };
+
+    /*
+     * Board of configurable size to measure how the simulation scales with it.
+     * A single core CPU with small memories runs the firmware, the buttons and LEDs form a cluster of their own that ticks alongside it
+     */
+    class SyntheticBoard : public Board {
+    public:
+        constexpr static inline u64 FlashBase       = 0x0000'0000;
+        constexpr static inline u64 RamBase         = 0x1000'0000;
+        constexpr static inline u64 PeripheralBase  = 0x6000'0000;
+        constexpr static inline u64 PeripheralStride = 0x100;
+
+        explicit SyntheticBoard(SyntheticBoardConfig config) : Board("Synthetic Board", { 500, 500 }),
+        cpu(createDevice<dev::CPUDevice>(1, Vec2{ 50, 50 })),
+        cpuFlash(FlashBase, 64_kiB),
+        cpuRam(RamBase, 64_kiB) {
+            auto &cpuAddressSpace = cpu.getAddressSpace();
+
+            cpuAddressSpace.addDevice(cpuFlash);
+            cpuAddressSpace.addDevice(cpuRam);
+
+            for (u32 i = 0; i < config.peripherals; i++) {
+                auto &gpio = this->cpuPeripherals.emplace_back(std::make_unique<dev::cpu::mmio::GPIO>(PeripheralBase + i * PeripheralStride));
+                cpuAddressSpace.addDevice(*gpio);
+            }
+
+            /* Tracks need at least one device on either end */
+            const auto deviceCount = config.tracks > 0 ? std::max(config.devices, 2U) : config.devices;
+            for (u32 i = 0; i < deviceCount; i++) {
+                const Vec2 position = { float(200 + (i % 16) * 20), float(50 + (i / 16) * 20) };
+
+                if (i % 2 == 0)
+                    this->buttons.push_back(&createDevice<dev::Button>(position));
+                else
+                    this->leds.push_back(&createDevice<dev::LED>(position));
+            }
+
+            for (u32 i = 0; i < config.tracks; i++)
+                this->createTrack(Direction::MOSI, "net" + std::to_string(i), *this->buttons[i % this->buttons.size()], *this->leds[i % this->leds.size()]);
+        }
+
+        dev::CPUDevice &cpu;
+
+        dev::cpu::mmio::Memory cpuFlash;
+        dev::cpu::mmio::Memory cpuRam;
+        std::vector<std::unique_ptr<dev::cpu::mmio::GPIO>> cpuPeripherals;
+
+        std::vector<dev::Button*> buttons;
+        std::vector<dev::LED*> leds;
+    };
+
+}
@@ -16,10 +16,10 @@ namespace vc::pcb {
     class TestBoard : public Board {
     public:
         TestBoard() : Board("Test Board", { 500, 300 }),
-        cpu(createDevice<dev::CPUDevice>(1, ImVec2{ 50, 50 })),
-        uartHeader(createDevice<dev::PinHeader>(ImVec2{ 200, 250 })),
-        buttonA(createDevice<dev::Button>(ImVec2({ 300, 250 }))),
-        ledA(createDevice<dev::LED>(ImVec2({ 100, 200 }))),
+        cpu(createDevice<dev::CPUDevice>(1, Vec2{ 50, 50 })),
+        uartHeader(createDevice<dev::PinHeader>(Vec2{ 200, 250 })),
+        buttonA(createDevice<dev::Button>(Vec2{ 300, 250 })),
+        ledA(createDevice<dev::LED>(Vec2{ 100, 200 })),
 
         cpuFlash(0x0000'0000, 1_MiB),
         cpuRam(0x1000'0000, 2_MiB),
@@ -30,6 +30,7 @@ namespace vc::pcb {
             cpu.attachToPin(0, cpuUartA.txPin);
             cpu.attachToPin(1, cpuGpioA.gpioPins[0]);
             cpu.attachToPin(2, cpuGpioA.gpioPins[1]);
+            cpu.attachToPin(3, cpuUartA.rxPin);
 
             cpuAddressSpace.addDevice(cpuFlash);
             cpuAddressSpace.addDevice(cpuRam);
@@ -39,11 +40,15 @@ namespace vc::pcb {
             cpuAddressSpace.loadELF("kernel.elf");
 
             this->createTrack(Direction::MOSI, "uarta_tx", cpu, uartHeader, true);
+            this->createTrack(Direction::MISO, "uarta_rx", cpu, uartHeader, true);
             this->createTrack(Direction::MISO, "buttona", cpu, buttonA);
             this->createTrack(Direction::MOSI, "leda", cpu, ledA);
             cpu.attachPinToTrack(0, "uarta_tx");
             cpu.attachPinToTrack(1, "buttona");
             cpu.attachPinToTrack(2, "leda");
+            cpu.attachPinToTrack(3, "uarta_rx");
+
+            this->captureGoldenState();
         }
 
         dev::cpu::mmio::Memory cpuFlash;
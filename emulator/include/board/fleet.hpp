@@ -0,0 +1,193 @@
+#pragma once
+
+#include <board/board.hpp>
+#include <board/runner.hpp>
+#include <work_stealing_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vc::pcb {
+
+    /* Outcome of a single board of a fleet */
+    struct FleetResult {
+        /* False if the factory failed to create the board, none of the other fields mean anything then */
+        bool created = false;
+        StopReason reason = StopReason::Halted;
+        std::optional<u32> exitCode;
+        u64 instructions = 0;
+        std::string output;
+        std::vector<u64> cycleReports;
+    };
+
+    struct FleetReport {
+        std::vector<FleetResult> boards;
+        double seconds = 0;
+        u64 steals = 0;
+
+        [[nodiscard]]
+        u64 getTotalInstructions() const {
+            u64 instructions = 0;
+            for (const auto &board : this->boards)
+                instructions += board.instructions;
+
+            return instructions;
+        }
+
+        [[nodiscard]]
+        u32 getCount(StopReason reason) const {
+            return std::count_if(this->boards.begin(), this->boards.end(), [reason](const FleetResult &board) { return board.created && board.reason == reason; });
+        }
+
+        [[nodiscard]]
+        u32 getNotCreatedCount() const {
+            return std::count_if(this->boards.begin(), this->boards.end(), [](const FleetResult &board) { return !board.created; });
+        }
+
+        /* Boards whose guest finished with an exit code of zero */
+        [[nodiscard]]
+        u32 getPassedCount() const {
+            return std::count_if(this->boards.begin(), this->boards.end(), [](const FleetResult &board) { return board.exitCode == 0U; });
+        }
+    };
+
+    /*
+     * Simulates many independent boards on a work stealing thread pool.
+     * A worker runs a board for one slice of instructions and then puts it at the back of its queue, so all boards in flight make progress side by side.
+     * Only a limited number of boards exist at any time, a new one gets created from the factory whenever one finishes
+     */
+    class Fleet {
+    public:
+        using Factory = std::function<std::unique_ptr<Board>(u32 index)>;
+
+        Fleet(u32 boardCount, Factory factory) : boardCount(boardCount), factory(std::move(factory)) { }
+
+        /* Zero sizes the pool to the host */
+        void setWorkerCount(u32 count) {
+            this->pool.setWorkerCount(count);
+        }
+
+        /* Instructions a board runs before the worker moves on to the next one */
+        void setSliceInstructions(u64 instructions) {
+            this->sliceInstructions = std::max<u64>(1, instructions);
+        }
+
+        /* Instructions every single board may run at most */
+        void setInstructionLimit(u64 instructions) {
+            this->instructionLimit = instructions;
+        }
+
+        /* Wall time the whole fleet may take, boards that didn't finish by then stop with StopReason::Timeout */
+        void setTimeout(std::chrono::steady_clock::duration timeout) {
+            this->timeout = timeout;
+        }
+
+        /* Upper bound for the number of boards that exist at the same time, zero keeps four per worker around */
+        void setMaxActiveBoards(u32 count) {
+            this->maxActiveBoards = count;
+        }
+
+        [[nodiscard]]
+        FleetReport run() {
+            FleetReport report;
+            report.boards.resize(this->boardCount);
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto deadline = this->timeout.has_value() ? start + *this->timeout : std::chrono::steady_clock::time_point::max();
+
+            const auto activeBoards = std::min(this->boardCount, this->maxActiveBoards != 0 ? this->maxActiveBoards : this->pool.getWorkerCount() * 4);
+            std::atomic<u32> nextIndex = activeBoards;
+
+            std::vector<std::unique_ptr<Job>> jobs;
+            for (u32 index = 0; index < activeBoards; index++)
+                jobs.push_back(std::make_unique<Job>(index));
+
+            this->pool.run(std::move(jobs), [&, this](std::unique_ptr<Job> job, u32) -> std::optional<std::unique_ptr<Job>> {
+                if (this->runSlice(*job, report.boards[job->index], deadline))
+                    return job;
+
+                /* The finished board gets destroyed right here, before the next one gets created */
+                job.reset();
+
+                auto index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+                if (index >= this->boardCount)
+                    return { };
+
+                return std::make_unique<Job>(index);
+            });
+
+            report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            report.steals = this->pool.getStealCount();
+
+            return report;
+        }
+
+    private:
+        struct Job {
+            explicit Job(u32 index) : index(index) { }
+
+            u32 index;
+            u64 instructions = 0;
+
+            std::unique_ptr<Board> board;
+            std::unique_ptr<Runner> runner;
+        };
+
+        /* Returns whether the board has to run again, otherwise its result got filled in */
+        bool runSlice(Job &job, FleetResult &result, std::chrono::steady_clock::time_point deadline) {
+            if (job.board == nullptr) {
+                job.board = this->factory(job.index);
+                if (job.board == nullptr) {
+                    log::error("Failed to create board {} of the fleet", job.index);
+                    return false;
+                }
+
+                /* Parallelism comes from running many boards at once, every board stays on the worker that runs it */
+                job.board->setWorkerCount(1);
+
+                job.runner = std::make_unique<Runner>(*job.board);
+                job.runner->setConsoleOutput(nullptr);
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) {
+                this->finish(job, result, StopReason::Timeout);
+                return false;
+            }
+
+            auto run = job.runner->run(std::min(this->sliceInstructions, this->instructionLimit - job.instructions));
+            job.instructions += run.instructions;
+
+            if (run.reason == StopReason::InstructionLimit && job.instructions < this->instructionLimit)
+                return true;
+
+            this->finish(job, result, run.reason);
+            return false;
+        }
+
+        void finish(Job &job, FleetResult &result, StopReason reason) {
+            result.created = true;
+            result.reason = reason;
+            result.exitCode = job.runner->getExitCode();
+            result.instructions = job.instructions;
+            result.output = job.runner->getOutput();
+            result.cycleReports = job.runner->getCycleReports();
+        }
+
+        u32 boardCount;
+        Factory factory;
+        util::WorkStealingPool<std::unique_ptr<Job>> pool;
+
+        u64 sliceInstructions = 1'000'000;
+        u64 instructionLimit = std::numeric_limits<u64>::max();
+        u32 maxActiveBoards = 0;
+        std::optional<std::chrono::steady_clock::duration> timeout;
+    };
+
+}
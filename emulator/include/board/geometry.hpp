@@ -0,0 +1,15 @@
+#pragma once
+
+namespace vc::pcb {
+
+    /* Position or size on the board in layout units. Only used to describe the layout, the simulation itself never looks at it */
+    struct Vec2 {
+        float x = 0, y = 0;
+
+        constexpr Vec2 operator+(const Vec2 &other) const { return { this->x + other.x, this->y + other.y }; }
+        constexpr Vec2 operator-(const Vec2 &other) const { return { this->x - other.x, this->y - other.y }; }
+        constexpr Vec2 operator*(float factor) const { return { this->x * factor, this->y * factor }; }
+        constexpr Vec2 operator/(float divisor) const { return { this->x / divisor, this->y / divisor }; }
+    };
+
+}
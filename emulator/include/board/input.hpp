@@ -0,0 +1,45 @@
+#pragma once
+
+#include <risc.hpp>
+#include <ring_buffer.hpp>
+
+#include <mutex>
+#include <optional>
+
+namespace vc::pcb {
+
+    /* Input coming from outside of the simulation, addressed to a device by its index on the board */
+    struct InputEvent {
+        u32 device;
+        u32 channel;
+        u64 value;
+    };
+
+    /*
+     * Filled from outside of the simulation, drained by it between two windows of virtual time.
+     * The UI and host side injection may post from different threads, so pushes get serialized by a mutex. Draining stays lock-free
+     */
+    class InputQueue {
+    public:
+        explicit InputQueue(size_t capacity) : events(capacity) { }
+
+        bool push(const InputEvent &event) {
+            std::scoped_lock lock(this->producerMutex);
+            return this->events.push(event);
+        }
+
+        [[nodiscard]]
+        std::optional<InputEvent> pop() {
+            return this->events.pop();
+        }
+
+        void clear() {
+            this->events.clear();
+        }
+
+    private:
+        std::mutex producerMutex;
+        util::RingBuffer<InputEvent> events;
+    };
+
+}
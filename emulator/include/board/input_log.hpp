@@ -0,0 +1,220 @@
+#pragma once
+
+#include <risc.hpp>
+#include <utils.hpp>
+#include <board/input.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace vc::pcb {
+
+    /*
+     * Compact log of all input events that reached a board, each one tagged with the virtual time it got applied at.
+     * Events are stored as LEB128 encoded time delta, device, channel and value, which keeps a typical button press or UART byte at four to six bytes.
+     * Inputs only ever get applied between two windows of virtual time, so replaying the log with the same lookahead reproduces the run exactly
+     */
+    class InputLog {
+    public:
+        struct Entry {
+            u64 time;
+            InputEvent event;
+        };
+
+        InputLog() = default;
+        explicit InputLog(u64 lookahead) : lookahead(lookahead) { }
+
+        void append(u64 time, const InputEvent &event) {
+            writeNumber(time - this->lastTime);
+            writeNumber(event.device);
+            writeNumber(event.channel);
+            writeNumber(event.value);
+
+            this->lastTime = time;
+            this->eventCount++;
+        }
+
+        /* Drops all events applied before the given time. A log that lost events can't be replayed from power up anymore */
+        void dropBefore(u64 time) {
+            if (this->keep([time](const Entry &entry) { return entry.time >= time; }))
+                this->complete = false;
+        }
+
+        /* Drops all events applied after the given time */
+        void dropAfter(u64 time) {
+            this->keep([time](const Entry &entry) { return entry.time <= time; });
+        }
+
+        /* True if the log holds every event since power up */
+        [[nodiscard]]
+        bool isComplete() const {
+            return this->complete;
+        }
+
+        /* Lookahead of the board the log got recorded on, replaying with a different one applies the inputs at different points in time */
+        [[nodiscard]]
+        u64 getLookahead() const {
+            return this->lookahead;
+        }
+
+        [[nodiscard]]
+        u64 getEventCount() const {
+            return this->eventCount;
+        }
+
+        /* Size of the encoded events in bytes */
+        [[nodiscard]]
+        size_t getSize() const {
+            return this->data.size();
+        }
+
+        bool save(std::string_view path) const {
+            FILE *file = fopen(std::string(path).c_str(), "wb");
+            if (file == nullptr) return false;
+            ON_SCOPE_EXIT { fclose(file); };
+
+            InputLog header;
+            header.data.insert(header.data.end(), std::begin(Magic), std::end(Magic));
+            header.writeNumber(Version);
+            header.writeNumber(this->lookahead);
+            header.writeNumber(this->eventCount);
+
+            return fwrite(header.data.data(), 1, header.data.size(), file) == header.data.size() && fwrite(this->data.data(), 1, this->data.size(), file) == this->data.size();
+        }
+
+        [[nodiscard]]
+        static std::optional<InputLog> load(std::string_view path) {
+            std::vector<u8> buffer;
+
+            {
+                FILE *file = fopen(std::string(path).c_str(), "rb");
+                if (file == nullptr) return { };
+                ON_SCOPE_EXIT { fclose(file); };
+
+                fseek(file, 0, SEEK_END);
+                size_t size = ftell(file);
+                rewind(file);
+
+                buffer.resize(size, 0x00);
+                if (fread(buffer.data(), 1, buffer.size(), file) != buffer.size())
+                    return { };
+            }
+
+            if (buffer.size() < sizeof(Magic) || std::memcmp(buffer.data(), Magic, sizeof(Magic)) != 0)
+                return { };
+
+            size_t position = sizeof(Magic);
+            auto version = readNumber(buffer, position);
+            auto lookahead = readNumber(buffer, position);
+            auto eventCount = readNumber(buffer, position);
+            if (!version.has_value() || *version != Version || !lookahead.has_value() || !eventCount.has_value())
+                return { };
+
+            InputLog log(*lookahead);
+            log.data.assign(buffer.begin() + position, buffer.end());
+            log.eventCount = *eventCount;
+
+            /* Events appended to a loaded log continue from the time of its last one */
+            for (Reader reader(log); reader.peek().has_value(); reader.pop())
+                log.lastTime = reader.peek()->time;
+
+            return log;
+        }
+
+        /* Walks through the events of a log in the order they got recorded */
+        class Reader {
+        public:
+            explicit Reader(const InputLog &log) : log(&log) { }
+
+            /* Next event without consuming it, nothing once the end of the log is reached */
+            [[nodiscard]]
+            const std::optional<Entry>& peek() {
+                if (!this->next.has_value() && this->position < this->log->data.size()) {
+                    auto delta   = readNumber(this->log->data, this->position);
+                    auto device  = readNumber(this->log->data, this->position);
+                    auto channel = readNumber(this->log->data, this->position);
+                    auto value   = readNumber(this->log->data, this->position);
+
+                    if (delta.has_value() && device.has_value() && channel.has_value() && value.has_value()) {
+                        this->time += *delta;
+                        this->next = Entry { this->time, { u32(*device), u32(*channel), *value } };
+                    } else {
+                        this->position = this->log->data.size();
+                    }
+                }
+
+                return this->next;
+            }
+
+            void pop() {
+                this->next.reset();
+            }
+
+        private:
+            const InputLog *log;
+            size_t position = 0;
+            u64 time = 0;
+            std::optional<Entry> next;
+        };
+
+    private:
+        constexpr static inline u8 Magic[] = { 'V', 'C', 'I', 'L' };
+        constexpr static inline u64 Version = 1;
+
+        /* Encodes the events to keep once more, returns true if any got dropped */
+        bool keep(auto predicate) {
+            InputLog remaining(this->lookahead);
+            remaining.complete = this->complete;
+
+            Reader reader(*this);
+            while (reader.peek().has_value()) {
+                const auto entry = *reader.peek();
+                reader.pop();
+
+                if (predicate(entry))
+                    remaining.append(entry.time, entry.event);
+            }
+
+            if (remaining.eventCount == this->eventCount)
+                return false;
+
+            *this = std::move(remaining);
+            return true;
+        }
+
+        void writeNumber(u64 value) {
+            do {
+                u8 byte = value & 0x7F;
+                value >>= 7;
+                this->data.push_back(byte | (value != 0 ? 0x80 : 0x00));
+            } while (value != 0);
+        }
+
+        [[nodiscard]]
+        static std::optional<u64> readNumber(const std::vector<u8> &buffer, size_t &position) {
+            u64 value = 0;
+
+            for (u32 shift = 0; shift < 64; shift += 7) {
+                if (position >= buffer.size())
+                    return { };
+
+                const auto byte = buffer[position++];
+                value |= u64(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0x00)
+                    return value;
+            }
+
+            return { };
+        }
+
+        std::vector<u8> data;
+        u64 lookahead = 0;
+        u64 lastTime = 0;
+        u64 eventCount = 0;
+        bool complete = true;
+    };
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace vc::pcb {
+
+    /*
+     * Dependency graph between the devices of a board. Every edge points from the device driving a track to the device reading it.
+     * levelize() assigns each device a level so that evaluating all devices in ascending level order settles every combinational path in a single pass.
+     * Devices that are part of a feedback loop get collapsed into one group, the edges inside such a loop are treated as clocked boundaries
+     * whose values only become visible in the next pass.
+     */
+    class Netlist {
+    public:
+        explicit Netlist(u32 nodeCount) : successors(nodeCount) { }
+
+        void connect(u32 driver, u32 receiver) {
+            this->successors[driver].push_back(receiver);
+        }
+
+        void levelize() {
+            const auto nodeCount = u32(this->successors.size());
+
+            this->index.assign(nodeCount, Unvisited);
+            this->lowLink.assign(nodeCount, 0);
+            this->onStack.assign(nodeCount, false);
+            this->component.assign(nodeCount, 0);
+            this->stack.clear();
+            this->nextIndex = 0;
+            this->componentCount = 0;
+            this->feedbackEdgeCount = 0;
+
+            for (u32 node = 0; node < nodeCount; node++) {
+                if (this->index[node] == Unvisited)
+                    this->findComponents(node);
+            }
+
+            /* Tarjan emits components in reverse topological order, flip them so that drivers come first */
+            for (auto &comp : this->component)
+                comp = this->componentCount - 1 - comp;
+
+            std::vector<u32> componentLevel(this->componentCount, 0);
+            std::vector<u32> nodesByComponent(nodeCount);
+            for (u32 node = 0; node < nodeCount; node++)
+                nodesByComponent[node] = node;
+            std::stable_sort(nodesByComponent.begin(), nodesByComponent.end(), [this](u32 a, u32 b) {
+                return this->component[a] < this->component[b];
+            });
+
+            for (auto node : nodesByComponent) {
+                for (auto successor : this->successors[node]) {
+                    auto from = this->component[node], to = this->component[successor];
+
+                    if (from == to)
+                        this->feedbackEdgeCount++;
+                    else
+                        componentLevel[to] = std::max(componentLevel[to], componentLevel[from] + 1);
+                }
+            }
+
+            this->levels.resize(nodeCount);
+            this->levelCount = 0;
+            for (u32 node = 0; node < nodeCount; node++) {
+                this->levels[node] = componentLevel[this->component[node]];
+                this->levelCount = std::max(this->levelCount, this->levels[node] + 1);
+            }
+        }
+
+        [[nodiscard]]
+        const std::vector<u32>& getLevels() const {
+            return this->levels;
+        }
+
+        [[nodiscard]]
+        u32 getLevelCount() const {
+            return this->levelCount;
+        }
+
+        [[nodiscard]]
+        u32 getFeedbackEdgeCount() const {
+            return this->feedbackEdgeCount;
+        }
+
+    private:
+        constexpr static inline u32 Unvisited = std::numeric_limits<u32>::max();
+
+        /* Iterative so that long chains of devices can't overflow the stack, every frame remembers which successor to visit next */
+        void findComponents(u32 root) {
+            this->callStack.clear();
+            this->visit(root);
+
+            while (!this->callStack.empty()) {
+                auto &[node, next] = this->callStack.back();
+
+                if (next < this->successors[node].size()) {
+                    auto successor = this->successors[node][next++];
+
+                    if (this->index[successor] == Unvisited)
+                        this->visit(successor);
+                    else if (this->onStack[successor])
+                        this->lowLink[node] = std::min(this->lowLink[node], this->index[successor]);
+
+                    continue;
+                }
+
+                const auto finished = node;
+                this->callStack.pop_back();
+
+                if (this->lowLink[finished] == this->index[finished]) {
+                    u32 member;
+                    do {
+                        member = this->stack.back();
+                        this->stack.pop_back();
+                        this->onStack[member] = false;
+                        this->component[member] = this->componentCount;
+                    } while (member != finished);
+
+                    this->componentCount++;
+                }
+
+                if (!this->callStack.empty()) {
+                    auto parent = this->callStack.back().node;
+                    this->lowLink[parent] = std::min(this->lowLink[parent], this->lowLink[finished]);
+                }
+            }
+        }
+
+        void visit(u32 node) {
+            this->index[node] = this->lowLink[node] = this->nextIndex++;
+            this->stack.push_back(node);
+            this->onStack[node] = true;
+            this->callStack.push_back({ node, 0 });
+        }
+
+        struct Frame {
+            u32 node;
+            u32 next;
+        };
+
+        std::vector<std::vector<u32>> successors;
+
+        std::vector<u32> index, lowLink, component, stack;
+        std::vector<Frame> callStack;
+        std::vector<bool> onStack;
+        u32 nextIndex = 0, componentCount = 0;
+
+        std::vector<u32> levels;
+        u32 levelCount = 0, feedbackEdgeCount = 0;
+    };
+
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/mmio/test_finisher.hpp>
+#include <devices/cpu/core/mmio/cycle_counter.hpp>
+#include <devices/serial_console.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vc::pcb {
+
+    enum class StopReason {
+        InstructionLimit,   /* A core retired the requested number of instructions */
+        Breakpoint,         /* A core is about to execute the requested address */
+        Output,             /* The requested pattern showed up on the serial console */
+        Finished,           /* The guest wrote to the test finisher */
+        Timeout,            /* The wall time limit ran out */
+        Halted              /* No device had any work left */
+    };
+
+    struct RunResult {
+        StopReason reason;
+        u64 instructions;   /* Retired by all cores during the run */
+    };
+
+    /*
+     * Drives a board from the calling thread in batches instead of powering it up on a thread of its own.
+     * Every call continues where the last one stopped and returns once the stop condition was met, which gets checked without any per instruction callbacks:
+     * instruction limits and addresses stop the cores exactly through their debug stops, everything else gets checked at window boundaries.
+     * The runner owns the board's window listener and its cores' breakpoints for as long as it exists
+     */
+    class Runner {
+    public:
+        constexpr static inline u64 Unlimited = std::numeric_limits<u64>::max();
+
+        explicit Runner(Board &board) : board(board) {
+            for (auto &device : board.getDevices()) {
+                if (auto cpu = dynamic_cast<dev::CPUDevice*>(device); cpu != nullptr && this->cpu == nullptr)
+                    this->cpu = cpu;
+                else if (auto console = dynamic_cast<dev::SerialConsole*>(device); console != nullptr && this->console == nullptr)
+                    this->console = console;
+            }
+
+            if (this->cpu != nullptr) {
+                for (auto &mmio : this->cpu->getAddressSpace().getDevices()) {
+                    if (auto finisher = dynamic_cast<dev::cpu::mmio::TestFinisher*>(mmio); finisher != nullptr)
+                        this->finisher = finisher;
+                    else if (auto cycleCounter = dynamic_cast<dev::cpu::mmio::CycleCounter*>(mmio); cycleCounter != nullptr)
+                        this->cycleCounter = cycleCounter;
+                }
+
+                for (u32 i = 0; i < this->cpu->getCoreCount(); i++)
+                    this->cpu->getCore(i).setBreakpoints(&this->breakpoints);
+            }
+
+            if (this->console != nullptr)
+                this->console->setCapture(true);
+
+            this->board.setWindowListener([this] {
+                if (this->shouldStop())
+                    this->board.powerDown();
+            });
+        }
+
+        ~Runner() {
+            this->board.setWindowListener(nullptr);
+
+            if (this->cpu != nullptr) {
+                for (u32 i = 0; i < this->cpu->getCoreCount(); i++)
+                    this->cpu->getCore(i).setBreakpoints(nullptr);
+            }
+        }
+
+        Runner(const Runner&) = delete;
+        Runner& operator=(const Runner&) = delete;
+
+        /* Runs until every core retired up to maxInstructions more instructions */
+        RunResult run(u64 maxInstructions = Unlimited) {
+            return this->runWith(maxInstructions, { }, { });
+        }
+
+        /* Runs until a core is about to execute the instruction at the given address. A core that's already there has to come back to it first */
+        RunResult runUntil(u64 pc, u64 maxInstructions = Unlimited) {
+            return this->runWith(maxInstructions, pc, { });
+        }
+
+        /* Runs until the pattern shows up in the serial console's output. Only output received during this call gets searched */
+        RunResult runUntilOutput(std::string_view pattern, u64 maxInstructions = Unlimited) {
+            if (this->console == nullptr)
+                log::error("Board '{}' has no serial console to wait for output on", this->board.getName());
+
+            return this->runWith(maxInstructions, { }, pattern);
+        }
+
+        /* Starts over from the board's golden state on the next run */
+        void restart() {
+            this->started = false;
+        }
+
+        /* Wall time every following run may take at most. Checked at window boundaries */
+        void setTimeout(std::chrono::steady_clock::duration timeout) {
+            this->timeout = timeout;
+        }
+
+        /* Keeping everything the console received is what output patterns get searched in, long runs that don't need it can turn it off */
+        void setCaptureOutput(bool enabled) {
+            if (this->console != nullptr)
+                this->console->setCapture(enabled);
+        }
+
+        /* Where the serial console echoes what it receives to, nothing to only capture it */
+        void setConsoleOutput(FILE *file) {
+            if (this->console != nullptr)
+                this->console->setOutput(file);
+        }
+
+        /* Everything the serial console received since the board got started */
+        [[nodiscard]]
+        std::string_view getOutput() const {
+            if (this->console == nullptr)
+                return { };
+
+            return this->console->getCapturedOutput();
+        }
+
+        [[nodiscard]]
+        std::optional<u32> getExitCode() const {
+            if (this->finisher == nullptr)
+                return { };
+
+            return this->finisher->getExitCode();
+        }
+
+        /* Cycle counts the guest reported through the cycle counter since the board got started */
+        [[nodiscard]]
+        std::vector<u64> getCycleReports() const {
+            if (this->cycleCounter == nullptr)
+                return { };
+
+            return this->cycleCounter->getReports();
+        }
+
+        [[nodiscard]]
+        Board& getBoard() {
+            return this->board;
+        }
+
+        [[nodiscard]]
+        dev::CPUDevice* getCPU() {
+            return this->cpu;
+        }
+
+    private:
+        RunResult runWith(u64 maxInstructions, std::optional<u64> pc, std::optional<std::string_view> pattern) {
+            /* Starting resets the cores, which would drop their stop positions again. Whatever got loaded into the memories up to here is what every restart goes back to */
+            if (!std::exchange(this->started, true)) {
+                if (!this->board.hasGoldenState())
+                    this->board.captureGoldenState();
+
+                this->board.start();
+            }
+
+            const auto startInstructions = this->getRetiredInstructions();
+
+            this->breakpoints.clear();
+            if (pc.has_value())
+                this->breakpoints.add(*pc);
+
+            if (this->cpu != nullptr) {
+                for (u32 i = 0; i < this->cpu->getCoreCount(); i++) {
+                    auto &core = this->cpu->getCore(i);
+                    core.setBreakpoints(&this->breakpoints);
+                    core.debugResumeUntil(maxInstructions == Unlimited ? Unlimited : core.getRetiredInstructions() + maxInstructions);
+                }
+            }
+
+            this->pattern = pattern;
+            if (pattern.has_value() && this->console != nullptr) {
+                this->console->setCapture(true);
+                this->searchStart = this->console->getCapturedOutput().size();
+            }
+            this->outputMatched = false;
+            this->timedOut = false;
+            this->deadline = this->timeout.has_value() ? std::chrono::steady_clock::now() + *this->timeout : std::chrono::steady_clock::time_point::max();
+
+            this->board.run();
+
+            return { this->getStopReason(), this->getRetiredInstructions() - startInstructions };
+        }
+
+        /* Runs at every window boundary while all partitions are stopped */
+        [[nodiscard]]
+        bool shouldStop() {
+            if (this->getExitCode().has_value())
+                return true;
+
+            if (this->cpu != nullptr && this->cpu->wantsPause())
+                return true;
+
+            if (this->pattern.has_value() && this->console != nullptr) {
+                const auto &output = this->console->getCapturedOutput();
+
+                if (output.find(*this->pattern, this->searchStart) != std::string::npos) {
+                    this->outputMatched = true;
+                    return true;
+                }
+
+                /* Only the tail that could still be the start of a match has to be searched again */
+                if (output.size() >= this->pattern->size())
+                    this->searchStart = std::max(this->searchStart, output.size() - this->pattern->size() + 1);
+            }
+
+            if (std::chrono::steady_clock::now() >= this->deadline) {
+                this->timedOut = true;
+                return true;
+            }
+
+            return false;
+        }
+
+        [[nodiscard]]
+        StopReason getStopReason() const {
+            if (this->getExitCode().has_value())
+                return StopReason::Finished;
+
+            if (this->cpu != nullptr) {
+                for (u32 i = 0; i < this->cpu->getCoreCount(); i++) {
+                    switch (this->cpu->getCore(i).getStopReason()) {
+                        case dev::cpu::StopReason::Breakpoint:  return StopReason::Breakpoint;
+                        case dev::cpu::StopReason::Step:        return StopReason::InstructionLimit;
+                        default: break;
+                    }
+                }
+            }
+
+            if (this->outputMatched)
+                return StopReason::Output;
+            if (this->timedOut)
+                return StopReason::Timeout;
+
+            return StopReason::Halted;
+        }
+
+        [[nodiscard]]
+        u64 getRetiredInstructions() const {
+            if (this->cpu == nullptr)
+                return 0;
+
+            u64 instructions = 0;
+            for (u32 i = 0; i < this->cpu->getCoreCount(); i++)
+                instructions += this->cpu->getRetiredInstructions(i);
+
+            return instructions;
+        }
+
+        Board &board;
+        dev::CPUDevice *cpu = nullptr;
+        dev::SerialConsole *console = nullptr;
+        dev::cpu::mmio::TestFinisher *finisher = nullptr;
+        dev::cpu::mmio::CycleCounter *cycleCounter = nullptr;
+
+        dev::cpu::Breakpoints breakpoints;
+        bool started = false;
+
+        std::optional<std::chrono::steady_clock::duration> timeout;
+        std::chrono::steady_clock::time_point deadline;
+
+        std::optional<std::string_view> pattern;
+        size_t searchStart = 0;
+        bool outputMatched = false, timedOut = false;
+    };
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <devices/device.hpp>
+#include <board/track.hpp>
+#include <counter.hpp>
+#include <state.hpp>
+
+namespace vc::pcb {
+
+    /* Group of devices that share one clock domain and always get simulated together on the same thread */
+    struct Partition {
+        std::vector<dev::Device*> devices;
+        u64 time = 0;
+        bool didWork = false;
+
+        /* Number of device ticks executed in this partition so far */
+        util::Counter ticks;
+    };
+
+    /*
+     * Conservative parallel simulation of a set of partitions.
+     * Partitions only talk to each other through channel tracks that delay every value by exactly one lookahead window.
+     * All partitions advance through the same window of virtual time independently and meet at a barrier at the end of it,
+     * which makes the result independent of how many worker threads are used and how partitions are distributed between them.
+     */
+    class Scheduler {
+    public:
+        Scheduler() : workerCount(std::max(1U, std::thread::hardware_concurrency())) { }
+
+        void setWorkerCount(u32 count) {
+            this->workerCount = std::max(1U, count);
+        }
+
+        [[nodiscard]]
+        u32 getWorkerCount() const {
+            return this->workerCount;
+        }
+
+        void setLookahead(u64 ticks) {
+            this->lookahead = std::max<u64>(1, ticks);
+        }
+
+        [[nodiscard]]
+        u64 getLookahead() const {
+            return this->lookahead;
+        }
+
+        [[nodiscard]]
+        std::vector<Partition>& getPartitions() {
+            return this->partitions;
+        }
+
+        /* Gets called between two windows while all partitions are stopped */
+        void setWindowCallback(std::function<void()> callback) {
+            this->windowCallback = std::move(callback);
+        }
+
+        void addChannel(Track *track) {
+            this->channels.push_back(track);
+        }
+
+        void reset() {
+            for (auto &partition : this->partitions) {
+                partition.time = 0;
+                partition.didWork = false;
+            }
+
+            this->windowEnd.store(0, std::memory_order_relaxed);
+        }
+
+        /* Clocks of all partitions, only called between two windows of virtual time */
+        void saveState(util::StateWriter &state) const {
+            state.write(this->windowEnd.load(std::memory_order_relaxed));
+            for (const auto &partition : this->partitions) {
+                state.write(partition.time);
+                state.write(partition.didWork);
+            }
+        }
+
+        void loadState(util::StateReader &state) {
+            this->windowEnd.store(state.read<u64>(), std::memory_order_relaxed);
+            for (auto &partition : this->partitions) {
+                state.read(partition.time);
+                state.read(partition.didWork);
+            }
+        }
+
+        /* Virtual time the partitions are currently advancing towards, safe to be read from any thread */
+        [[nodiscard]]
+        u64 getTime() const {
+            return this->windowEnd.load(std::memory_order_relaxed);
+        }
+
+        /* Simulates until no partition has any work left or until power is cut */
+        void run(const std::atomic<bool> &hasPower) {
+            const auto threadCount = std::max<u32>(1, std::min<u32>(this->workerCount, this->partitions.size()));
+            bool running = true;
+
+            this->advanceWindow();
+
+            std::barrier sync(threadCount, [&]() noexcept {
+                if (this->windowCallback)
+                    this->windowCallback();
+
+                bool doneWork = false;
+                for (auto &partition : this->partitions) {
+                    doneWork = doneWork || partition.didWork;
+                    partition.didWork = false;
+                }
+
+                bool dataInFlight = std::any_of(this->channels.begin(), this->channels.end(), [](Track *channel) {
+                    return channel->hasPendingData();
+                });
+
+                running = hasPower && (doneWork || dataInFlight);
+                if (running)
+                    this->advanceWindow();
+            });
+
+            auto worker = [&, this](u32 id) {
+                do {
+                    for (u32 i = id; i < this->partitions.size(); i += threadCount)
+                        this->runPartition(this->partitions[i]);
+
+                    sync.arrive_and_wait();
+                } while (running);
+            };
+
+            std::vector<std::thread> threads;
+            for (u32 id = 1; id < threadCount; id++)
+                threads.emplace_back(worker, id);
+
+            worker(0);
+
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+    private:
+        void advanceWindow() {
+            this->windowEnd.store(this->windowEnd.load(std::memory_order_relaxed) + this->lookahead, std::memory_order_relaxed);
+        }
+
+        void runPartition(Partition &partition) {
+            const auto windowEnd = this->windowEnd.load(std::memory_order_relaxed);
+            u64 ticks = 0;
+
+            for (; partition.time < windowEnd; partition.time++) {
+                for (auto &device : partition.devices) {
+                    if (device->needsUpdate()) {
+                        device->tick();
+                        ticks++;
+                    }
+                }
+            }
+
+            if (ticks > 0) {
+                partition.didWork = true;
+                partition.ticks.add(ticks);
+            }
+        }
+
+        u32 workerCount;
+        u64 lookahead = 64;
+        std::atomic<u64> windowEnd = 0;
+
+        std::vector<Partition> partitions;
+        std::vector<Track*> channels;
+        std::function<void()> windowCallback;
+    };
+
+}
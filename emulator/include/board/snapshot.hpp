@@ -0,0 +1,25 @@
+#pragma once
+
+#include <risc.hpp>
+#include <mapped_memory.hpp>
+#include <board/input_log.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace vc::pcb {
+
+    /*
+     * Complete state of a board at a window boundary, including the contents of all memories and every input it received up to that point.
+     * Memory contents are kept as images that all boards restored from the snapshot map copy-on-write, restoring is therefore cheap no matter how large the memories are
+     */
+    struct Snapshot {
+        u64 time;
+        u64 lookahead;
+
+        std::vector<u8> state;
+        std::vector<std::shared_ptr<const util::MemoryImage>> images;
+        InputLog inputs;
+    };
+
+}
@@ -1,18 +1,20 @@
 #pragma once
 
 #include <risc.hpp>
+#include <ring_buffer.hpp>
+#include <state.hpp>
+#include <board/input.hpp>
+#include <board/geometry.hpp>
 
-#include <queue>
+#include <atomic>
 #include <optional>
-#include <map>
-#include <mutex>
-
-#include <imgui.h>
-#define IMGUI_DEFINE_MATH_OPERATORS
-#include <imgui_internal.h>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace vc::pcb {
 
+    class Board;
     class Connectable;
 
     enum class Direction {
@@ -20,48 +22,172 @@ namespace vc::pcb {
         MOSI
     };
 
+    using TrackId = u32;
+
+    /*
+     * What happens to values written while a track's buffer is full. There's deliberately no policy that blocks the writer:
+     * the reader sits in the same partition and with that on the same thread, waiting for it to make space would never end
+     */
+    enum class Backpressure {
+        Drop,           /* Discard the value that got written */
+        OverwriteOldest /* Discard the oldest buffered value to make room, the reader always sees the most recent ones */
+    };
+
+    /* Channels between partitions always drop since only their reader may take values out */
+    struct TrackBuffer {
+        size_t capacity = 4096;
+        Backpressure backpressure = Backpressure::Drop;
+    };
+
     class Track {
     public:
-        Track(Direction direction, bool buffered, Connectable *from, Connectable *to) : direction(direction), buffered(buffered), from(from), to(to) {
+        Track(TrackId id, Direction direction, bool buffered, Connectable *from, Connectable *to, TrackBuffer bufferConfig = { }) : id(id), direction(direction), buffered(buffered), backpressure(bufferConfig.backpressure), from(from), to(to) {
+            if (this->buffered)
+                this->receivedData.emplace(bufferConfig.capacity);
+        }
 
+        /*
+         * Turns this track into a channel between two partitions that get simulated independently of each other.
+         * Every value is tagged with the writer's virtual time plus the latency and only becomes visible to the reader once its own clock got there.
+         * Channels never block the writer, values written while the channel is full get dropped
+         */
+        void makeChannel(const u64 *writerClock, const u64 *readerClock, u64 latency, size_t capacity) {
+            this->writerClock = writerClock;
+            this->readerClock = readerClock;
+            this->latency = latency;
+            this->channel.emplace(capacity);
+        }
+
+        [[nodiscard]]
+        bool isChannel() const {
+            return this->channel.has_value();
         }
 
         [[nodiscard]]
         std::optional<u8> getValue() {
-            std::scoped_lock lk(this->modifyMutex);
+            if (this->channel.has_value())
+                return this->getChannelValue();
 
-            if (this->buffered) {
-                if (this->receivedData.empty())
-                    return { };
-                auto item = this->receivedData.front();
-                this->receivedData.pop();
-                return item;
-            } else {
-                if (!this->value.has_value())
-                    return { };
-                auto item = this->value.value();
-                this->value.reset();
-                return item;
-            }
+            if (this->buffered)
+                return this->receivedData->pop();
+
+            if (this->latch.load(std::memory_order_relaxed) == 0x00)
+                return { };
+
+            auto item = this->latch.exchange(0x00, std::memory_order_acquire);
+            if ((item & LatchValid) == 0x00)
+                return { };
+
+            return u8(item);
         }
 
         [[nodiscard]]
         bool hasValue() {
-            std::scoped_lock lock(this->modifyMutex);
+            if (this->channel.has_value()) {
+                auto entry = this->channel->peek();
+                return entry != nullptr && entry->timestamp <= *this->readerClock;
+            }
 
             if (this->buffered)
-                return !this->receivedData.empty();
+                return !this->receivedData->empty();
             else
-                return this->value.has_value();
+                return this->latch.load(std::memory_order_acquire) != 0x00;
         }
 
         void setValue(u8 value) {
-            std::scoped_lock lock(this->modifyMutex);
+            if (this->channel.has_value()) {
+                this->lastTimestamp = *this->writerClock + this->latency;
+                if (!this->channel->push({ this->lastTimestamp, value }))
+                    return this->countDrop();
+
+                if (this->buffered || value != this->lastValue) {
+                    this->lastValue = value;
+                    this->countChange();
+                }
+            } else if (this->buffered) {
+                if (!this->receivedData->push(value)) {
+                    if (this->backpressure == Backpressure::Drop)
+                        return this->countDrop();
+
+                    /* Reader and writer run on the same thread here, so the writer may take a value out of the ring itself */
+                    [[maybe_unused]] auto oldest = this->receivedData->pop();
+                    this->receivedData->push(value);
+                    this->countDrop();
+                }
+
+                this->countChange();
+            } else {
+                this->latch.store(LatchValid | value, std::memory_order_release);
 
+                if (value != this->lastValue) {
+                    this->lastValue = value;
+                    this->countChange();
+                }
+            }
+        }
+
+        /* True if a channel still carries values that its reader's clock hasn't reached yet */
+        [[nodiscard]]
+        bool hasPendingData() const {
+            return this->channel.has_value() && this->lastTimestamp > *this->readerClock;
+        }
+
+        void clear() {
+            if (this->channel.has_value())
+                this->channel->clear();
             if (this->buffered)
-                this->receivedData.emplace(value);
-            else
-                this->value = value;
+                this->receivedData->clear();
+
+            this->latch = 0x00;
+            this->lastValue = LatchValid;
+            this->lastTimestamp = 0;
+        }
+
+        /* Values in flight on the track. Only called between two windows of virtual time */
+        void saveState(util::StateWriter &state) const {
+            state.write(this->latch.load(std::memory_order_relaxed));
+            state.write(this->lastValue);
+            state.write(this->lastTimestamp);
+
+            if (this->buffered) {
+                std::vector<u8> values;
+                this->receivedData->forEach([&](u8 value) { values.push_back(value); });
+                state.writeBytes(values);
+            }
+
+            if (this->channel.has_value()) {
+                state.write<u64>(this->channel->size());
+                this->channel->forEach([&](const ChannelEntry &entry) { state.write(entry); });
+            }
+        }
+
+        void loadState(util::StateReader &state) {
+            this->latch.store(state.read<u16>(), std::memory_order_relaxed);
+            state.read(this->lastValue);
+            state.read(this->lastTimestamp);
+
+            if (this->buffered) {
+                this->receivedData->clear();
+                for (auto value : state.readBytes())
+                    this->receivedData->push(value);
+            }
+
+            if (this->channel.has_value()) {
+                this->channel->clear();
+                for (auto count = state.read<u64>(); count > 0; count--)
+                    this->channel->push(state.read<ChannelEntry>());
+            }
+        }
+
+        /* Number of bytes pushed into a buffered track or number of value changes on an unbuffered one */
+        [[nodiscard]]
+        u64 getChangeCount() const {
+            return this->changeCount.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]]
+        u64 getDroppedCount() const {
+            return this->droppedCount.load(std::memory_order_relaxed);
         }
 
         [[nodiscard]]
@@ -74,12 +200,56 @@ namespace vc::pcb {
             return this->direction;
         }
 
+        [[nodiscard]]
+        TrackId getId() const {
+            return this->id;
+        }
+
     private:
+        constexpr static inline u16 LatchValid = 0x100;
+
+        struct ChannelEntry {
+            u64 timestamp;
+            u8 value;
+        };
+
+        [[nodiscard]]
+        std::optional<u8> getChannelValue() {
+            std::optional<u8> result;
+
+            /* Buffered channels hand out one value at a time, unbuffered ones only the most recent value that arrived */
+            while (this->hasValue()) {
+                result = this->channel->pop()->value;
+                if (this->buffered)
+                    break;
+            }
+
+            return result;
+        }
+
+        void countChange() {
+            this->changeCount.store(this->changeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void countDrop() {
+            this->droppedCount.store(this->droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        TrackId id;
         Direction direction;
         bool buffered;
-        std::mutex modifyMutex;
-        std::optional<u8> value;
-        std::queue<u8> receivedData;
+        Backpressure backpressure;
+
+        std::atomic<u16> latch = 0x00;
+        std::optional<util::RingBuffer<u8>> receivedData;
+
+        /* Only ever written by the driving side of the track */
+        u16 lastValue = LatchValid;
+        std::atomic<u64> changeCount = 0, droppedCount = 0;
+
+        std::optional<util::RingBuffer<ChannelEntry>> channel;
+        const u64 *writerClock = nullptr, *readerClock = nullptr;
+        u64 latency = 0, lastTimestamp = 0;
 
         Connectable *from, *to;
     };
@@ -88,61 +258,85 @@ namespace vc::pcb {
     public:
         friend class Board;
     protected:
-        auto getTrack(std::string_view name) {
-            return this->connectedTracks[std::string(name)];
+        /* Name based lookup, only meant to be used while the board is being set up */
+        [[nodiscard]]
+        pcb::Track* getTrack(std::string_view name) const {
+            for (u32 slot = 0; slot < this->connectedTrackNames.size(); slot++) {
+                if (this->connectedTrackNames[slot] == name)
+                    return this->connectedTracks[slot];
+            }
+
+            return nullptr;
         }
 
         void linkTrack(const std::string &name, pcb::Track *track) {
-            this->connectedTracks.insert({ name, track });
+            if (this->getTrack(name) != nullptr) return;
+
+            this->connectedTrackNames.push_back(name);
+            this->connectedTracks.push_back(track);
         }
 
+        /* Called once by the board after all devices and tracks have been created. Resolve all name based connections here */
+        virtual void elaborate() { }
+
         [[nodiscard]]
-        bool dataAvailable() {
-            for (auto &[name, track] : this->connectedTracks)
+        bool dataAvailable() const {
+            for (const auto &track : this->connectedTracks)
                 if (track->hasValue())
                     return true;
 
             return false;
         }
 
-        auto getConnectedTrackNames() {
-            std::vector<std::string_view> result;
-
-            for (auto &[name, track] : this->connectedTracks)
-                result.push_back(name);
-
-            return result;
+    public:
+        /* Sends an input event to the simulation side of this device. Meant to be called from outside of the simulation, e.g. the UI thread */
+        void postInput(u32 channel, u64 value) {
+            if (this->inputQueue != nullptr)
+                this->inputQueue->push({ this->deviceIndex, channel, value });
         }
 
+        [[nodiscard]]
+        const std::vector<pcb::Track*>& getConnectedTracks() const {
+            return this->connectedTracks;
+        }
 
-        virtual void draw(ImVec2 start, ImDrawList *drawList) {
-            drawList->AddRectFilled(start + position, start + position + size, ImColor(0x10, 0x10, 0x10, 0xFF));
+        [[nodiscard]]
+        std::string_view getConnectedTrackName(u32 slot) const {
+            return this->connectedTrackNames[slot];
         }
 
-    public:
+        /* Updates position and size of the device, called by the UI before it lays out the board */
+        virtual void layout() { }
+
         [[nodiscard]]
-        ImVec2 getPosition() const {
+        Vec2 getPosition() const {
             return this->position;
         }
 
-        void setPosition(ImVec2 pos) {
+        void setPosition(Vec2 pos) {
             this->position = pos;
         }
 
         [[nodiscard]]
-        ImVec2 getSize() const {
+        Vec2 getSize() const {
             return this->size;
         }
 
-        void setSize(ImVec2 size) {
+        void setSize(Vec2 size) {
             this->size = size;
         }
 
     private:
-        std::map<std::string, pcb::Track*> connectedTracks;
+        std::vector<pcb::Track*> connectedTracks;
+        std::vector<std::string> connectedTrackNames;
+
+        /* Board the device got created on, set once by the board itself */
+        const Board *board = nullptr;
+        InputQueue *inputQueue = nullptr;
+        u32 deviceIndex = 0;
 
-        ImVec2 position;
-        ImVec2 size;
+        Vec2 position;
+        Vec2 size;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <atomic>
+
+namespace vc::util {
+
+    /*
+     * Statistics counter that is only ever incremented by a single thread but may be read from any other thread.
+     * Increments are a plain relaxed load and store, no read-modify-write, so they're cheap enough to stay enabled in hot paths
+     */
+    class Counter {
+    public:
+        Counter() = default;
+        Counter(const Counter &other) : value(other.get()) { }
+
+        Counter& operator=(const Counter &other) {
+            this->value.store(other.get(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        void add(u64 amount = 1) {
+            this->value.store(this->value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        /* Only meant to be used by the writing thread, e.g. when rewinding state */
+        void set(u64 value) {
+            this->value.store(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]]
+        u64 get() const {
+            return this->value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<u64> value = 0;
+    };
+
+}
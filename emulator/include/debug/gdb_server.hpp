@@ -0,0 +1,92 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/breakpoints.hpp>
+#include <devices/cpu/core/watchpoints.hpp>
+#include <debug/time_machine.hpp>
+
+namespace vc::debug {
+
+    /*
+     * GDB remote serial protocol server for the cores of a CPU. Every core shows up as a thread.
+     * The whole board gets paused while GDB considers the target to be stopped, all register and memory accesses happen during that time only
+     */
+    class GDBServer {
+    public:
+        GDBServer(pcb::Board &board, dev::CPUDevice &cpu);
+        ~GDBServer();
+
+        GDBServer(const GDBServer&) = delete;
+        GDBServer& operator=(const GDBServer&) = delete;
+
+        /* Starts listening on 127.0.0.1 */
+        bool listenTcp(u16 port);
+
+        /* Starts listening on a Unix domain socket at the given path */
+        bool listenUnix(std::string_view path);
+
+        void stop();
+
+        /* Enables reverse stepping and continuing. Has to be set before a client attaches */
+        void setTimeMachine(TimeMachine *timeMachine);
+
+    private:
+        void serve();
+        void handleClient(int client);
+
+        [[nodiscard]]
+        std::optional<std::string> receivePacket(int client);
+        void sendPacket(int client, std::string_view data);
+
+        [[nodiscard]]
+        std::string handlePacket(int client, std::string_view packet);
+
+        /* Resumes the board and blocks until it stopped again or GDB interrupted it */
+        [[nodiscard]]
+        std::string waitForStop(int client, std::optional<u32> steppingCore);
+
+        [[nodiscard]]
+        std::string stopReply();
+
+        void pauseBoard();
+        void resumeCores(std::optional<u32> steppingCore);
+        void updateBreakpoints();
+        void updateWatchpoints();
+
+        /* Handles GDB's monitor command, returns the text to print */
+        [[nodiscard]]
+        std::string handleMonitorCommand(std::string_view command);
+
+        [[nodiscard]]
+        std::string readRegisters();
+        [[nodiscard]]
+        std::string readMemory(u64 address, u64 length);
+        [[nodiscard]]
+        std::string targetDescription() const;
+
+        pcb::Board &board;
+        dev::CPUDevice &cpu;
+        dev::cpu::Breakpoints breakpoints;
+        dev::cpu::Watchpoints watchpoints;
+        TimeMachine *timeMachine = nullptr;
+
+        int listenSocket = -1;
+        std::string unixPath;
+        std::thread serverThread;
+        std::atomic<bool> running = false;
+
+        u32 selectedCore = 0;
+        bool interrupted = false;
+        std::string receiveBuffer;
+    };
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/profile.hpp>
+#include <debug/symbol_table.hpp>
+
+namespace vc::debug {
+
+    /*
+     * Samples where the firmware on every core of a CPU spends its time. Every core samples its program counter and call stack each interval-th instruction,
+     * which keeps the overhead low enough to leave profiling on for whole runs. Results get resolved through the firmware's symbols once the board stopped
+     */
+    class Profiler {
+    public:
+        constexpr static inline u32 DefaultInterval = 97;
+
+        explicit Profiler(dev::CPUDevice &cpu, u32 interval = DefaultInterval);
+        ~Profiler();
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        [[nodiscard]]
+        u64 getSampleCount() const;
+
+        /* Everything below may only be called while the board isn't running */
+
+        /* Samples per function, both in the function itself and in anything it called */
+        void writeFlatProfile(FILE *file, const SymbolTable &symbols) const;
+
+        /* One "frame;frame;frame count" line per distinct stack, as read by flamegraph.pl, inferno and speedscope */
+        void writeCollapsedStacks(FILE *file, const SymbolTable &symbols) const;
+
+    private:
+        dev::CPUDevice &cpu;
+        std::vector<std::unique_ptr<dev::cpu::Profile>> profiles;
+    };
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utils.hpp>
+#include <elf.hpp>
+
+namespace vc::debug {
+
+    /*
+     * Function symbols of an ELF file's .symtab as a sorted list of non-overlapping address ranges, so resolving an address is a single binary search.
+     * Symbols without a size reach up to the next symbol
+     */
+    class SymbolTable {
+    public:
+        struct Symbol {
+            u64 address, size;
+            std::string name;
+        };
+
+        bool loadELF(std::string_view path) {
+            std::vector<u8> buffer;
+
+            {
+                FILE *file = fopen(std::string(path).c_str(), "rb");
+                if (file == nullptr) return false;
+                ON_SCOPE_EXIT { fclose(file); };
+
+                fseek(file, 0, SEEK_END);
+                size_t size = ftell(file);
+                rewind(file);
+
+                buffer.resize(size, 0x00);
+                if (fread(buffer.data(), 1, buffer.size(), file) != buffer.size()) return false;
+            }
+
+            if (buffer.size() < sizeof(elf64_hdr))
+                return false;
+
+            elf64_hdr elfHeader = { 0 };
+            std::memcpy(&elfHeader, buffer.data(), sizeof(elf64_hdr));
+
+            if (elfHeader.e_shentsize != sizeof(elf64_shdr) || elfHeader.e_shoff + u64(elfHeader.e_shnum) * sizeof(elf64_shdr) > buffer.size())
+                return false;
+
+            std::vector<elf64_shdr> sectionHeader(elfHeader.e_shnum, { 0 });
+            std::memcpy(sectionHeader.data(), buffer.data() + elfHeader.e_shoff, sectionHeader.size() * sizeof(elf64_shdr));
+
+            auto inFile = [&](const elf64_shdr &section) {
+                return section.sh_offset <= buffer.size() && section.sh_size <= buffer.size() - section.sh_offset;
+            };
+
+            std::vector<Symbol> functions, labels;
+            for (const auto &section : sectionHeader) {
+                if (section.sh_type != SHT_SYMTAB || section.sh_link >= sectionHeader.size())
+                    continue;
+
+                const auto &strings = sectionHeader[section.sh_link];
+                if (!inFile(section) || !inFile(strings) || strings.sh_type != SHT_STRTAB)
+                    continue;
+
+                for (u64 offset = 0; offset + sizeof(elf64_sym) <= section.sh_size; offset += sizeof(elf64_sym)) {
+                    elf64_sym symbol = { 0 };
+                    std::memcpy(&symbol, buffer.data() + section.sh_offset + offset, sizeof(elf64_sym));
+
+                    if (symbol.st_shndx == SHN_UNDEF || symbol.st_name >= strings.sh_size)
+                        continue;
+
+                    const auto nameStart = reinterpret_cast<const char*>(buffer.data() + strings.sh_offset + symbol.st_name);
+                    const std::string_view name(nameStart, strnlen(nameStart, strings.sh_size - symbol.st_name));
+
+                    /* Hand written assembly often doesn't type its symbols. Those only get used if there's no function symbol at all */
+                    if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC)
+                        functions.push_back({ symbol.st_value, symbol.st_size, demangle(name) });
+                    else if (ELF64_ST_TYPE(symbol.st_info) == STT_NOTYPE && !name.empty() && !name.starts_with(".L") && !name.starts_with("$"))
+                        labels.push_back({ symbol.st_value, symbol.st_size, std::string(name) });
+                }
+            }
+
+            this->symbols = std::move(functions.empty() ? labels : functions);
+            this->buildIndex();
+
+            log::info("Loaded {} symbols from {}", this->symbols.size(), path);
+
+            return true;
+        }
+
+        /* Symbol covering the address, nullptr if there's none */
+        [[nodiscard]]
+        const Symbol* find(u64 address) const {
+            auto next = std::upper_bound(this->symbols.begin(), this->symbols.end(), address, [](u64 address, const Symbol &symbol) {
+                return address < symbol.address;
+            });
+
+            if (next == this->symbols.begin())
+                return nullptr;
+
+            const auto &symbol = *std::prev(next);
+            if (address - symbol.address >= symbol.size)
+                return nullptr;
+
+            return &symbol;
+        }
+
+        /* Name of the function containing the address, the address itself if there's none */
+        [[nodiscard]]
+        std::string getName(u64 address) const {
+            if (auto symbol = this->find(address); symbol != nullptr)
+                return symbol->name;
+            else
+                return fmt::format("{:#x}", address);
+        }
+
+        [[nodiscard]]
+        const std::vector<Symbol>& getSymbols() const {
+            return this->symbols;
+        }
+
+    private:
+        [[nodiscard]]
+        static std::string demangle(std::string_view name) {
+            const std::string mangled(name);
+
+            int status = 0;
+            char *demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+            if (demangled == nullptr)
+                return mangled;
+            ON_SCOPE_EXIT { std::free(demangled); };
+
+            return status == 0 ? std::string(demangled) : mangled;
+        }
+
+        /* Aliases collapse into the first symbol at an address, every range gets cut off where the next one starts */
+        void buildIndex() {
+            std::stable_sort(this->symbols.begin(), this->symbols.end(), [](const Symbol &a, const Symbol &b) {
+                return a.address < b.address;
+            });
+
+            auto last = std::unique(this->symbols.begin(), this->symbols.end(), [](const Symbol &a, const Symbol &b) {
+                return a.address == b.address;
+            });
+            this->symbols.erase(last, this->symbols.end());
+
+            for (size_t i = 0; i < this->symbols.size(); i++) {
+                auto &symbol = this->symbols[i];
+                const u64 end = i + 1 < this->symbols.size() ? this->symbols[i + 1].address : std::numeric_limits<u64>::max();
+
+                if (symbol.size == 0 || symbol.size > end - symbol.address)
+                    symbol.size = end - symbol.address;
+            }
+        }
+
+        std::vector<Symbol> symbols;
+    };
+
+}
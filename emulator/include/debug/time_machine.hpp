@@ -0,0 +1,118 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/mmio/memory.hpp>
+#include <dirty_bitmap.hpp>
+
+namespace vc::debug {
+
+    /*
+     * Reverse execution through periodic checkpoints and deterministic replay.
+     * A checkpoint holds the board's state together with copies of the memory pages written since the checkpoint before it, so memory overhead grows with
+     * what the firmware writes and not with the size of its memories. Going back restores the closest checkpoint in front of the target and replays forward.
+     * Checkpoints are spaced so replaying from one to the next takes about half of the latency target at the measured simulation speed
+     */
+    class TimeMachine {
+    public:
+        TimeMachine(pcb::Board &board, dev::CPUDevice &cpu);
+        ~TimeMachine();
+
+        TimeMachine(const TimeMachine&) = delete;
+        TimeMachine& operator=(const TimeMachine&) = delete;
+
+        /* Upper bound for how long going back a single instruction may take */
+        void setLatencyTarget(std::chrono::milliseconds latency);
+
+        /* Oldest checkpoints get merged away once their page copies take up more than this */
+        void setMemoryLimit(size_t bytes);
+
+        /*
+         * Everything below may only be called while the board is paused.
+         * Both return false if the history doesn't reach back far enough, the core then gets left at the oldest point there is
+         */
+        bool reverseStep(u32 core);
+        bool reverseContinue(u32 core);
+
+        [[nodiscard]]
+        size_t getCheckpointCount() const;
+
+        [[nodiscard]]
+        size_t getMemoryUsage() const;
+
+        [[nodiscard]]
+        u64 getCheckpointInterval() const;
+
+    private:
+        constexpr static inline u64 PageSize = 4096;
+
+        struct PageCopy {
+            u32 region;
+            u64 page;
+            std::vector<u8> data;
+        };
+
+        struct Checkpoint {
+            u64 time;
+
+            /* Retired instructions of every core */
+            std::vector<u64> positions;
+
+            std::vector<u8> state;
+            std::vector<PageCopy> pages;
+        };
+
+        struct Region {
+            dev::cpu::mmio::Memory *memory;
+            std::unique_ptr<util::DirtyBitmap> tracker;
+
+            /* Contents at the time of the oldest checkpoint */
+            std::vector<u8> base;
+        };
+
+        void onWindow();
+
+        void startHistory();
+        void takeCheckpoint();
+        void dropOldestCheckpoint();
+        void restore(size_t index);
+
+        /* Latest checkpoint that the core hadn't gone past the given position yet */
+        [[nodiscard]]
+        std::optional<size_t> findCheckpoint(u32 core, u64 position) const;
+
+        /* Replays until the core retired the given number of instructions, breakpoints and watchpoints only get noted down on the way */
+        bool replayTo(u32 core, u64 position);
+
+        [[nodiscard]]
+        static size_t getSize(const Checkpoint &checkpoint);
+
+        pcb::Board &board;
+        dev::CPUDevice &cpu;
+
+        std::vector<Region> regions;
+        std::deque<Checkpoint> checkpoints;
+        size_t memoryUsage = 0, memoryLimit = 256_MiB;
+
+        std::chrono::nanoseconds latencyTarget = std::chrono::milliseconds(100);
+        u64 interval = 0;
+
+        /* Simulation speed measured between checkpoints, windows that had the board paused in between don't count */
+        std::chrono::steady_clock::time_point lastWindow;
+        u64 lastWindowTime = 0, lastPauseCount = 0;
+        u64 measuredTicks = 0;
+        std::chrono::nanoseconds measuredDuration = { };
+
+        /* Core that is being replayed to a position, lets the board pause again should the core never get there */
+        std::optional<std::pair<u32, u64>> replayTarget;
+    };
+
+}
@@ -6,7 +6,7 @@ namespace vc::dev {
 
     class Button : public Device, public pcb::Connectable {
     public:
-        explicit Button(ImVec2 pos) {
+        explicit Button(pcb::Vec2 pos) {
             this->setPosition(pos);
             this->setSize({ 31, 31 });
         }
@@ -16,10 +16,8 @@ namespace vc::dev {
         }
 
         void tick() override {
-            for (auto &trackName : this->getConnectedTrackNames()) {
-                auto track = this->getTrack(trackName);
+            for (auto &track : this->getConnectedTracks())
                 track->setValue(this->pressed);
-            }
         }
 
         bool needsUpdate() override { return true; }
@@ -27,11 +25,16 @@ namespace vc::dev {
             pressed = false;
         }
 
-        void draw(ImVec2 start, ImDrawList *drawList) override {
-            this->pressed = ImGui::IsMouseHoveringRect(start + getPosition(), start + getPosition() + getSize()) && ImGui::IsMouseDown(ImGuiMouseButton_Left);
+        void saveState(util::StateWriter &state) override {
+            state.write(this->pressed);
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->pressed);
+        }
 
-            drawList->AddRectFilled(start + getPosition(), start + getPosition() + getSize(), ImColor(0xA0, 0xA0, 0xA0, 0xFF));
-            drawList->AddCircleFilled(start + getPosition() + getSize() / 2,  9, this->pressed ? ImColor(0x80, 0x20, 0x20, 0xFF) : ImColor(0xA0, 0x20, 0x20, 0xFF));
+        void applyInput(u32, u64 value) override {
+            this->pressed = value != 0;
         }
 
     private:
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <risc.hpp>
+#include <optional>
 #include <set>
+#include <span>
 #include <devices/cpu/core/mmio/device.hpp>
+#include <devices/cpu/core/watchpoints.hpp>
 #include <utils.hpp>
 #include <elf.hpp>
 
@@ -20,7 +23,7 @@ namespace vc::dev::cpu {
     public:
         void addDevice(mmio::MMIODevice &device) {
             for (const auto mappedDevice : this->devices) {
-                if (device.getBase() >= mappedDevice->getBase() && device.getEnd() <= mappedDevice->getEnd() || mappedDevice->getBase() >= device.getBase() && mappedDevice->getEnd() <= device.getEnd())
+                if ((device.getBase() >= mappedDevice->getBase() && device.getEnd() <= mappedDevice->getEnd()) || (mappedDevice->getBase() >= device.getBase() && mappedDevice->getEnd() <= device.getEnd()))
                     log::fatal("Tried to map device to occupied address range");
             }
 
@@ -64,11 +67,84 @@ namespace vc::dev::cpu {
             return device->doubleWord(address - device->getBase());
         }
 
+        /*
+         * Data loads go through here instead of the access operators so they can be caught by watchpoints.
+         * A hit at the skipped address, belonging to the core doing the access, gets let through once
+         */
+        template<typename Tag>
+        [[nodiscard]]
+        u64 read(u64 address, Tag, std::optional<u64> *skippedWatchpoint = nullptr) {
+            constexpr static u8 Size = accessSize<Tag>();
+
+            auto device = findDevice(address, Size);
+            if (device == nullptr) {
+                log::error("Invalid memory access at {:#x}", address);
+                throw AccessFaultException();
+            }
+
+            const auto offset = address - device->getBase();
+            auto &value = access<Tag>(*device, offset);
+
+            if (device->isWatched(offset, Size)) [[unlikely]]
+                this->checkWatchpoints(address, Size, WatchpointType::Read, value, skippedWatchpoint);
+
+            return value;
+        }
+
+        /* Stores go through here instead of the access operators so devices can track what got written */
+        template<typename Tag>
+        void write(u64 address, u64 value, Tag, std::optional<u64> *skippedWatchpoint = nullptr) {
+            constexpr static u8 Size = accessSize<Tag>();
+
+            auto device = findDevice(address, Size);
+            if (device == nullptr) {
+                log::error("Invalid memory access at {:#x}", address);
+                throw AccessFaultException();
+            }
+
+            const auto offset = address - device->getBase();
+
+            if (device->isWatched(offset, Size)) [[unlikely]]
+                this->checkWatchpoints(address, Size, WatchpointType::Write, value & (u64(-1) >> (64 - Size * 8)), skippedWatchpoint);
+
+            device->markWritten(offset, Size);
+            access<Tag>(*device, offset) = value;
+        }
+
+        /* Debugger write that doesn't trigger any watchpoints. Returns false if the address isn't mapped */
+        bool poke(u64 address, u8 value) {
+            auto device = findDevice(address, 1);
+            if (device == nullptr)
+                return false;
+
+            const auto offset = address - device->getBase();
+            device->markWritten(offset, 1);
+            device->byte(offset) = value;
+
+            return true;
+        }
+
+        /* Side effect free read for debugging purposes. Returns nothing if the address isn't mapped */
+        [[nodiscard]]
+        std::optional<u8> peek(u64 address) const {
+            auto device = findDevice(address, 1);
+            if (device == nullptr)
+                return { };
+
+            return device->peek(address - device->getBase());
+        }
+
         void tickDevices() {
             for (auto &device : this->devices)
                 device->doTick();
         }
 
+        /* Copies raw code or data into whatever devices back the given range */
+        void loadBinary(u64 address, std::span<const u8> data) {
+            for (u64 offset = 0; offset < data.size(); offset++)
+                this->write(address + offset, data[offset], byte_tag{});
+        }
+
         bool loadELF(std::string_view path) {
             std::vector<u8> buffer;
 
@@ -88,12 +164,15 @@ namespace vc::dev::cpu {
             {
                 elf64_hdr elfHeader = { 0 };
                 std::memcpy(&elfHeader, buffer.data() + 0, sizeof(elf64_hdr));
-                std::vector<elf64_phdr> programHeader(elfHeader.e_phnum - 1, { 0 });
+                std::vector<elf64_phdr> programHeader(elfHeader.e_phnum, { 0 });
                 std::memcpy(programHeader.data(), buffer.data() + elfHeader.e_phoff, elfHeader.e_phentsize * programHeader.size());
 
                 for (const auto &pheader : programHeader) {
-                    for (u32 offset = 0; offset < pheader.p_filesz; offset++)
-                        this->operator()(pheader.p_paddr + offset, byte_tag{}) = buffer[pheader.p_offset + offset];
+                    /* Segments like the RISC-V attributes don't belong into memory */
+                    if (pheader.p_type != PT_LOAD)
+                        continue;
+
+                    this->loadBinary(pheader.p_paddr, { buffer.data() + pheader.p_offset, pheader.p_filesz });
                     log::info("Mapped section to {:#x}:{:#x}", pheader.p_paddr, pheader.p_paddr + pheader.p_memsz);
                 }
             }
@@ -105,11 +184,83 @@ namespace vc::dev::cpu {
         auto& getDevices() {
             return this->devices;
         }
+
+        /* May only be called while no core is running. Has to be called again after the watchpoints changed */
+        void setWatchpoints(Watchpoints *watchpoints) {
+            this->watchpoints = watchpoints;
+
+            for (auto &device : this->devices) {
+                std::vector<bool> pages;
+
+                if (watchpoints != nullptr) {
+                    for (const auto &watchpoint : watchpoints->get()) {
+                        const auto start = std::max(watchpoint.address, device->getBase());
+                        const auto end = std::min(watchpoint.address + watchpoint.size - 1, device->getEnd());
+                        if (watchpoint.size == 0 || start > end)
+                            continue;
+
+                        pages.resize((device->getSize() + (1 << mmio::MMIODevice::WatchPageShift) - 1) >> mmio::MMIODevice::WatchPageShift);
+                        for (auto page = (start - device->getBase()) >> mmio::MMIODevice::WatchPageShift; page <= (end - device->getBase()) >> mmio::MMIODevice::WatchPageShift; page++)
+                            pages[page] = true;
+                    }
+                }
+
+                device->setWatchedPages(std::move(pages));
+            }
+        }
+
+        [[nodiscard]]
+        Watchpoints* getWatchpoints() const {
+            return this->watchpoints;
+        }
+
     private:
+        template<typename Tag>
+        [[nodiscard]]
+        static auto& access(mmio::MMIODevice &device, u64 offset) {
+            if constexpr (std::same_as<Tag, byte_tag>)
+                return device.byte(offset);
+            else if constexpr (std::same_as<Tag, hword_tag>)
+                return device.halfWord(offset);
+            else if constexpr (std::same_as<Tag, word_tag>)
+                return device.word(offset);
+            else
+                return device.doubleWord(offset);
+        }
+
+        /* Slow path, only taken for accesses to pages that contain a watchpoint */
+        void checkWatchpoints(u64 address, u8 size, WatchpointType type, u64 value, std::optional<u64> *skippedWatchpoint) {
+            if (this->watchpoints == nullptr)
+                return;
+
+            auto watchpoint = this->watchpoints->find(address, size, type);
+            if (watchpoint == nullptr)
+                return;
+
+            if (skippedWatchpoint != nullptr && *skippedWatchpoint == address) {
+                skippedWatchpoint->reset();
+                return;
+            }
+
+            throw WatchpointException({ .pc = 0, .address = address, .value = value, .size = size, .access = type, .watchpoint = watchpoint->type }, watchpoint->action);
+        }
+
+        template<typename Tag>
+        constexpr static u8 accessSize() {
+            if constexpr (std::same_as<Tag, byte_tag>)
+                return 1;
+            else if constexpr (std::same_as<Tag, hword_tag>)
+                return 2;
+            else if constexpr (std::same_as<Tag, word_tag>)
+                return 4;
+            else
+                return 8;
+        }
+
         [[nodiscard]]
         mmio::MMIODevice* findDevice(u64 address, u8 accessSize) const {
             auto device = std::find_if(devices.begin(), devices.end(), [&](mmio::MMIODevice *curr){
-                return address >= curr->getBase() && address <= curr->getEnd() - accessSize;
+                return address >= curr->getBase() && address + accessSize - 1 <= curr->getEnd();
             });
 
             if (device == devices.end()) return nullptr;
@@ -118,6 +269,8 @@ namespace vc::dev::cpu {
         }
 
         std::set<mmio::MMIODevice*> devices;
+
+        Watchpoints *watchpoints = nullptr;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <devices/cpu/core/instructions.hpp>
+#include <log.hpp>
+
+#include <cstring>
+#include <optional>
+#include <vector>
+
+namespace vc::dev::cpu {
+
+    /*
+     * Encodes RV64 instructions straight into a buffer so guest programs can be built in process without a cross toolchain.
+     * Only covers what the core executes. Branches and jumps go to labels, which may be bound before or after they get used
+     */
+    class Assembler {
+    public:
+        using Register = u8;
+
+        struct Label {
+            size_t id;
+        };
+
+        explicit Assembler(u64 base = 0) : base(base) { }
+
+        /* Address the next instruction gets placed at */
+        [[nodiscard]]
+        u64 getAddress() const {
+            return this->base + this->code.size();
+        }
+
+        [[nodiscard]]
+        const std::vector<u8>& getCode() const {
+            for (const auto &fixup : this->fixups)
+                log::fatal("Label {} got used but never bound", fixup.label);
+
+            return this->code;
+        }
+
+        [[nodiscard]]
+        Label createLabel() {
+            this->labels.emplace_back();
+            return { this->labels.size() - 1 };
+        }
+
+        void bind(Label label) {
+            this->labels[label.id] = this->getAddress();
+
+            std::erase_if(this->fixups, [&, this](const Fixup &fixup) {
+                if (fixup.label != label.id)
+                    return false;
+
+                this->patch(fixup);
+                return true;
+            });
+        }
+
+        /* Base instructions */
+
+        void lui(Register rd, u32 immediate)                { this->emitU(Opcode::LUI, rd, immediate); }
+        void auipc(Register rd, u32 immediate)              { this->emitU(Opcode::AUIPC, rd, immediate); }
+
+        void addi(Register rd, Register rs1, i32 immediate) { this->emitI(Opcode::OP_IMM, u8(OPIMMFunc::ADDI), rd, rs1, immediate); }
+        void xori(Register rd, Register rs1, i32 immediate) { this->emitI(Opcode::OP_IMM, u8(OPIMMFunc::XORI), rd, rs1, immediate); }
+        void ori(Register rd, Register rs1, i32 immediate)  { this->emitI(Opcode::OP_IMM, u8(OPIMMFunc::ORI), rd, rs1, immediate); }
+        void andi(Register rd, Register rs1, i32 immediate) { this->emitI(Opcode::OP_IMM, u8(OPIMMFunc::ANDI), rd, rs1, immediate); }
+        void addiw(Register rd, Register rs1, i32 immediate){ this->emitI(Opcode::OP_IMM32, u8(OPIMM32Func::ADDIW), rd, rs1, immediate); }
+
+        void lb(Register rd, Register rs1, i32 offset)      { this->emitI(Opcode::LOAD, u8(LOADFunc::LB), rd, rs1, offset); }
+        void lbu(Register rd, Register rs1, i32 offset)     { this->emitI(Opcode::LOAD, u8(LOADFunc::LBU), rd, rs1, offset); }
+        void ld(Register rd, Register rs1, i32 offset)      { this->emitI(Opcode::LOAD, u8(LOADFunc::LD), rd, rs1, offset); }
+
+        void sb(Register rs2, Register rs1, i32 offset)     { this->emitS(u8(STOREFunc::SB), rs1, rs2, offset); }
+        void sh(Register rs2, Register rs1, i32 offset)     { this->emitS(u8(STOREFunc::SH), rs1, rs2, offset); }
+        void sw(Register rs2, Register rs1, i32 offset)     { this->emitS(u8(STOREFunc::SW), rs1, rs2, offset); }
+        void sd(Register rs2, Register rs1, i32 offset)     { this->emitS(u8(STOREFunc::SD), rs1, rs2, offset); }
+
+        void beq(Register rs1, Register rs2, Label target)  { this->emitBranch(u8(BRANCHFunc::BEQ), rs1, rs2, target); }
+        void bne(Register rs1, Register rs2, Label target)  { this->emitBranch(u8(BRANCHFunc::BNE), rs1, rs2, target); }
+
+        void jal(Register rd, Label target) {
+            this->emit32(u32(Opcode::JAL) | (u32(rd) << 7));
+            this->addFixup(Fixup::Type::Jump, target);
+        }
+
+        void jalr(Register rd, Register rs1, i32 offset)    { this->emitI(Opcode::JALR, 0b000, rd, rs1, offset); }
+
+        /* Loads a value that fits into 32 bits, sign extended like LUI does */
+        void li(Register rd, i32 value) {
+            const i32 low = (value << 20) >> 20;
+            const u32 high = u32(value - low);
+
+            if (high != 0) {
+                this->lui(rd, high);
+                if (low != 0)
+                    this->addiw(rd, rd, low);
+            } else {
+                this->addi(rd, 0, low);
+            }
+        }
+
+        /* Compressed instructions */
+
+        void c_li(Register rd, i32 immediate)               { this->emitCI(u8(C1Funct::C_LI), CompressedOpcode::C1, rd, immediate); }
+        void c_addi(Register rd, i32 immediate)             { this->emitCI(u8(C1Funct::C_ADDI), CompressedOpcode::C1, rd, immediate); }
+        void c_addiw(Register rd, i32 immediate)            { this->emitCI(u8(C1Funct::C_ADDIW), CompressedOpcode::C1, rd, immediate); }
+
+        void c_ldsp(Register rd, u32 offset) {
+            this->checkRange(offset, 0, 0x1F8, 8);
+            this->emit16((u16(C2Funct::C_LDSP) << 13) | (((offset >> 5) & 0b1) << 12) | (u16(rd) << 7) | (((offset >> 3) & 0b11) << 5) | (((offset >> 6) & 0b111) << 2) | u16(CompressedOpcode::C2));
+        }
+
+        void c_sdsp(Register rs2, u32 offset) {
+            this->checkRange(offset, 0, 0x1F8, 8);
+            this->emit16((u16(C2Funct::C_SDSP) << 13) | (((offset >> 3) & 0b111) << 10) | (((offset >> 6) & 0b111) << 7) | (u16(rs2) << 2) | u16(CompressedOpcode::C2));
+        }
+
+        void c_jr(Register rs1) {
+            this->emit16((u16(C2Funct::C_JUMP) << 13) | (u16(rs1) << 7) | u16(CompressedOpcode::C2));
+        }
+
+    private:
+        struct Fixup {
+            enum class Type { Branch, Jump } type;
+            size_t label;
+            size_t offset;
+        };
+
+        void checkRange(i64 value, i64 min, i64 max, i64 alignment = 1) const {
+            if (value < min || value > max || value % alignment != 0)
+                log::fatal("Immediate {:#x} at {:#x} can't be encoded", value, this->getAddress());
+        }
+
+        void emit16(u16 value) {
+            this->code.push_back(value & 0xFF);
+            this->code.push_back(value >> 8);
+        }
+
+        void emit32(u32 value) {
+            this->emit16(value & 0xFFFF);
+            this->emit16(value >> 16);
+        }
+
+        void emitI(Opcode opcode, u8 funct3, Register rd, Register rs1, i32 immediate) {
+            this->checkRange(immediate, -2048, 2047);
+            this->emit32(u32(opcode) | (u32(rd) << 7) | (u32(funct3) << 12) | (u32(rs1) << 15) | (u32(immediate) << 20));
+        }
+
+        void emitS(u8 funct3, Register rs1, Register rs2, i32 immediate) {
+            this->checkRange(immediate, -2048, 2047);
+            this->emit32(u32(Opcode::STORE) | ((u32(immediate) & 0b11111) << 7) | (u32(funct3) << 12) | (u32(rs1) << 15) | (u32(rs2) << 20) | ((u32(immediate) >> 5) << 25));
+        }
+
+        void emitU(Opcode opcode, Register rd, u32 immediate) {
+            this->checkRange(immediate & 0xFFF, 0, 0);
+            this->emit32(u32(opcode) | (u32(rd) << 7) | (immediate & 0xFFFF'F000));
+        }
+
+        void emitCI(u8 funct3, CompressedOpcode opcode, Register rd, i32 immediate) {
+            this->checkRange(immediate, -32, 31);
+            this->emit16((u16(funct3) << 13) | (((immediate >> 5) & 0b1) << 12) | (u16(rd) << 7) | ((immediate & 0b11111) << 2) | u16(opcode));
+        }
+
+        void emitBranch(u8 funct3, Register rs1, Register rs2, Label target) {
+            this->emit32(u32(Opcode::BRANCH) | (u32(funct3) << 12) | (u32(rs1) << 15) | (u32(rs2) << 20));
+            this->addFixup(Fixup::Type::Branch, target);
+        }
+
+        /* Refers to the instruction that just got emitted */
+        void addFixup(Fixup::Type type, Label label) {
+            const Fixup fixup = { type, label.id, this->code.size() - InstructionSize };
+
+            if (this->labels[label.id].has_value())
+                this->patch(fixup);
+            else
+                this->fixups.push_back(fixup);
+        }
+
+        /* Fills in the offset of an already emitted branch or jump once its target is known */
+        void patch(const Fixup &fixup) {
+            const i64 offset = i64(*this->labels[fixup.label]) - i64(this->base + fixup.offset);
+
+            u32 instruction;
+            std::memcpy(&instruction, this->code.data() + fixup.offset, sizeof(instruction));
+
+            const auto bits = u32(offset);
+            if (fixup.type == Fixup::Type::Branch) {
+                this->checkRange(offset, -4096, 4094, 2);
+                instruction |= (((bits >> 12) & 0b1) << 31) | (((bits >> 5) & 0b111111) << 25) | (((bits >> 1) & 0b1111) << 8) | (((bits >> 11) & 0b1) << 7);
+            } else {
+                this->checkRange(offset, -(1 << 20), (1 << 20) - 2, 2);
+                instruction |= (((bits >> 20) & 0b1) << 31) | (((bits >> 1) & 0x3FF) << 21) | (((bits >> 11) & 0b1) << 20) | (((bits >> 12) & 0xFF) << 12);
+            }
+
+            std::memcpy(this->code.data() + fixup.offset, &instruction, sizeof(instruction));
+        }
+
+        u64 base;
+        std::vector<u8> code;
+        std::vector<std::optional<u64>> labels;
+        std::vector<Fixup> fixups;
+    };
+
+}
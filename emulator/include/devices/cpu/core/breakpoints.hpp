@@ -0,0 +1,53 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vc::dev::cpu {
+
+    /*
+     * Set of breakpoint addresses together with the pages that contain at least one of them.
+     * Cores only ever look at the page table when their program counter enters a different page, so code in pages without breakpoints runs at full speed.
+     * May only be modified while the cores using it aren't running
+     */
+    class Breakpoints {
+    public:
+        constexpr static inline u64 PageShift = 12;
+
+        void add(u64 address) {
+            if (this->addresses.insert(address).second)
+                this->pages[address >> PageShift]++;
+        }
+
+        void remove(u64 address) {
+            if (this->addresses.erase(address) == 0)
+                return;
+
+            auto page = this->pages.find(address >> PageShift);
+            if (--page->second == 0)
+                this->pages.erase(page);
+        }
+
+        void clear() {
+            this->addresses.clear();
+            this->pages.clear();
+        }
+
+        [[nodiscard]]
+        bool contains(u64 address) const {
+            return this->addresses.contains(address);
+        }
+
+        [[nodiscard]]
+        bool hasBreakpointsInPage(u64 page) const {
+            return this->pages.contains(page);
+        }
+
+    private:
+        std::unordered_set<u64> addresses;
+        std::unordered_map<u64, u32> pages;
+    };
+
+}
@@ -4,12 +4,30 @@
 #include <devices/cpu/core/instructions.hpp>
 #include <devices/cpu/core/registers.hpp>
 #include <devices/cpu/core/address_space.hpp>
+#include <devices/cpu/core/breakpoints.hpp>
+#include <devices/cpu/core/profile.hpp>
+#include <counter.hpp>
 
+#include <limits>
+#include <optional>
 #include <thread>
 #include <chrono>
 
 namespace vc::dev::cpu {
 
+    enum class StopReason : u8 {
+        None,
+        Breakpoint,
+        Watchpoint,
+        Step
+    };
+
+    /* Breakpoint or watchpoint a core ran into while replaying, given as the number of instructions retired in front of it */
+    struct ReplayHit {
+        u64 position;
+        std::optional<u64> watchpointAddress;
+    };
+
     class Core {
     public:
         explicit Core(AddressSpace &addressSpace) : addressSpace(addressSpace) { }
@@ -19,6 +37,91 @@ namespace vc::dev::cpu {
         [[nodiscard]]
         bool isHalted() const { return halted; }
 
+        [[nodiscard]]
+        u64 getPC() const { return regs.pc; }
+
+        /* Total number of instructions this core has executed, safe to be read from any thread */
+        [[nodiscard]]
+        u64 getRetiredInstructions() const { return this->retiredInstructions.get(); }
+
+        /* Registers may only be accessed from outside of the simulation while the core isn't running */
+        [[nodiscard]]
+        Registers& getRegisters() { return this->regs; }
+
+        /* Breakpoints get checked whenever the program counter enters a page that contains any of them */
+        void setBreakpoints(const Breakpoints *breakpoints) {
+            this->breakpoints = breakpoints;
+            this->breakpointPage = NoPage;
+            this->breakpointsInPage = false;
+        }
+
+        /* Retired instructions and calls get reported to the profile as long as the core isn't replaying */
+        void setProfile(Profile *profile) {
+            this->profile = profile;
+        }
+
+        [[nodiscard]]
+        StopReason getStopReason() const { return this->stopReason; }
+
+        /* Access that made the core stop with StopReason::Watchpoint */
+        [[nodiscard]]
+        const WatchpointHit& getWatchpointHit() const { return this->watchpointHit; }
+
+        [[nodiscard]]
+        bool isDebugStopped() const { return this->stopReason != StopReason::None; }
+
+        /* Continues execution after a debug stop, either freely or for a single instruction */
+        void debugResume(bool step) {
+            this->debugResumeUntil(step ? this->getRetiredInstructions() + 1 : NoPosition);
+        }
+
+        /* Continues execution until the given total number of instructions got retired */
+        void debugResumeUntil(u64 position) {
+            this->stopReason = StopReason::None;
+            this->stopPosition = position;
+            /* A replay has to note down the breakpoint it starts on as well */
+            this->skipBreakpoint = !this->replaying && this->breakpoints != nullptr && this->breakpoints->contains(this->regs.pc);
+        }
+
+        /* While replaying, breakpoints and watchpoints don't stop the core. Only the last one it ran into gets remembered until the next replay starts */
+        void setReplaying(bool replaying) {
+            if (replaying)
+                this->lastHit.reset();
+
+            this->replaying = replaying;
+        }
+
+        [[nodiscard]]
+        const std::optional<ReplayHit>& getLastHit() const { return this->lastHit; }
+
+        /* Lets a hit at the given address through during the next instruction, used to repeat the access of an instruction that already triggered */
+        void skipWatchpoint(u64 address) {
+            this->skippedWatchpoint = address;
+        }
+
+        /* Architectural state only, any pending debug stop gets dropped */
+        void saveState(util::StateWriter &state) {
+            for (u8 r = 1; r < 32; r++)
+                state.write<u64>(this->regs.x[r]);
+            state.write(this->regs.pc);
+            state.write(this->halted);
+            state.write(this->getRetiredInstructions());
+        }
+
+        void loadState(util::StateReader &state) {
+            for (u8 r = 1; r < 32; r++)
+                this->regs.x[r] = state.read<u64>();
+            state.read(this->regs.pc);
+            state.read(this->halted);
+            this->retiredInstructions.set(state.read<u64>());
+
+            this->stopReason = StopReason::None;
+            this->stopPosition = NoPosition;
+            this->skipBreakpoint = false;
+            this->skippedWatchpoint.reset();
+            this->breakpointPage = NoPage;
+        }
+
         void reset() {
             this->regs.pc = 0x00;
             for (u8 r = 1; r < 32; r++)
@@ -37,10 +140,13 @@ namespace vc::dev::cpu {
         }
 
     private:
+        void executeNext();
+
         constexpr void executeCompressedInstruction(const CompressedInstruction &instr);
         constexpr void executeInstruction(const Instruction &instr);
 
         constexpr void executeOPInstruction(const Instruction &instr);
+        constexpr void executeOP32Instruction(const Instruction &instr);
         constexpr void executeOPIMMInstruction(const Instruction &instr);
         constexpr void executeOPIMM32Instruction(const Instruction &instr);
         constexpr void executeBRANCHInstruction(const Instruction &instr);
@@ -51,10 +157,25 @@ namespace vc::dev::cpu {
         constexpr void executeC1Instruction(const CompressedInstruction &instr);
         constexpr void executeC2Instruction(const CompressedInstruction &instr);
 
+        constexpr static inline u64 NoPage = std::numeric_limits<u64>::max();
+        constexpr static inline u64 NoPosition = std::numeric_limits<u64>::max();
+
         u64 nextPC;
         bool halted = true;
+
+        const Breakpoints *breakpoints = nullptr;
+        Profile *profile = nullptr;
+        u64 breakpointPage = NoPage;
+        bool breakpointsInPage = false, skipBreakpoint = false, replaying = false;
+        u64 stopPosition = NoPosition;
+        StopReason stopReason = StopReason::None;
+        WatchpointHit watchpointHit = { };
+        std::optional<u64> skippedWatchpoint;
+        std::optional<ReplayHit> lastHit;
         AddressSpace &addressSpace;
         Registers regs;
+
+        util::Counter retiredInstructions;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <risc.hpp>
+#include <devices/cpu/core/instructions.hpp>
+
+#include <optional>
+#include <string>
+
+namespace vc::dev::cpu {
+
+    struct DisassembledInstruction {
+        /* Size of the instruction in bytes, 2 for compressed and 4 for regular instructions */
+        u8 size;
+        std::string mnemonic;
+        std::string operands;
+
+        /* Absolute target address of jumps and branches */
+        std::optional<u64> target;
+    };
+
+    /* Length of the instruction starting with the given 16 bit parcel */
+    [[nodiscard]]
+    constexpr u8 getInstructionSize(u16 parcel) {
+        return (parcel & 0b11) == 0b11 ? InstructionSize : CompressedInstructionSize;
+    }
+
+    /* Decodes a single RV64GC instruction. For compressed instructions only the lower 16 bits get looked at */
+    [[nodiscard]]
+    DisassembledInstruction disassemble(u32 instruction, u64 address);
+
+}
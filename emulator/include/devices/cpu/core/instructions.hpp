@@ -25,7 +25,7 @@ namespace vc::dev::cpu {
         OP_IMM32        = 0b0011011,
         MISC_MEM        = 0b0001111,
         SYSTEM          = 0b1110011,
-        OP              = 0b0100011,
+        OP              = 0b0110011,
         OP_32           = 0b0111011,
         AMO             = 0b0101111,
         LOAD_FP         = 0b0000111,
@@ -44,7 +44,11 @@ namespace vc::dev::cpu {
     };
 
     enum class C0Funct : u8 {
-        C_ADDI4SPN      = 0b000
+        C_ADDI4SPN      = 0b000,
+        C_LW            = 0b010,
+        C_LD            = 0b011,
+        C_SW            = 0b110,
+        C_SD            = 0b111
     };
 
     enum class C1Funct : u8 {
@@ -52,32 +56,121 @@ namespace vc::dev::cpu {
         C_ADDIW         = 0b001,
         C_LI            = 0b010,
         C_LUI           = 0b011,
-        C_ANDI          = 0b100
+        C_ARITHMETIC    = 0b100,
+        C_J             = 0b101,
+        C_BEQZ          = 0b110,
+        C_BNEZ          = 0b111
+    };
+
+    enum class C1ArithmeticFunct : u8 {
+        C_SRLI          = 0b00,
+        C_SRAI          = 0b01,
+        C_ANDI          = 0b10,
+        C_REGISTER      = 0b11
     };
 
     enum class C2Funct : u8 {
+        C_SLLI          = 0b000,
+        C_LWSP          = 0b010,
         C_JUMP          = 0b100,
         C_LDSP          = 0b011,
+        C_SWSP          = 0b110,
         C_SDSP          = 0b111
     };
 
     enum class OPFunc3 : u8 {
-        ADD             = 0b000
+        ADD             = 0b000,
+        SUB             = 0b000,
+        SLL             = 0b001,
+        SLT             = 0b010,
+        SLTU            = 0b011,
+        XOR             = 0b100,
+        SRL             = 0b101,
+        SRA             = 0b101,
+        OR              = 0b110,
+        AND             = 0b111,
+
+        MUL             = 0b000,
+        MULH            = 0b001,
+        MULHSU          = 0b010,
+        MULHU           = 0b011,
+        DIV             = 0b100,
+        DIVU            = 0b101,
+        REM             = 0b110,
+        REMU            = 0b111
     };
 
     enum class OPFunc7 : u8 {
-        ADD             = 0b0000000
+        ADD             = 0b0000000,
+        SUB             = 0b0100000,
+        SLL             = 0b0000000,
+        SLT             = 0b0000000,
+        SLTU            = 0b0000000,
+        XOR             = 0b0000000,
+        SRL             = 0b0000000,
+        SRA             = 0b0100000,
+        OR              = 0b0000000,
+        AND             = 0b0000000,
+
+        MUL             = 0b0000001,
+        MULH            = 0b0000001,
+        MULHSU          = 0b0000001,
+        MULHU           = 0b0000001,
+        DIV             = 0b0000001,
+        DIVU            = 0b0000001,
+        REM             = 0b0000001,
+        REMU            = 0b0000001
+    };
+
+    enum class OP32Func3 : u8 {
+        ADDW            = 0b000,
+        SUBW            = 0b000,
+        SLLW            = 0b001,
+        SRLW            = 0b101,
+        SRAW            = 0b101,
+
+        MULW            = 0b000,
+        DIVW            = 0b100,
+        DIVUW           = 0b101,
+        REMW            = 0b110,
+        REMUW           = 0b111
+    };
+
+    enum class OP32Func7 : u8 {
+        ADDW            = 0b0000000,
+        SUBW            = 0b0100000,
+        SLLW            = 0b0000000,
+        SRLW            = 0b0000000,
+        SRAW            = 0b0100000,
+
+        MULW            = 0b0000001,
+        DIVW            = 0b0000001,
+        DIVUW           = 0b0000001,
+        REMW            = 0b0000001,
+        REMUW           = 0b0000001
     };
 
     enum class OPIMMFunc : u8 {
         ADDI            = 0b000,
+        SLLI            = 0b001,
+        SLTI            = 0b010,
+        SLTIU           = 0b011,
         XORI            = 0b100,
+        SRLI_SRAI       = 0b101,
         ORI             = 0b110,
         ANDI            = 0b111
     };
 
     enum class OPIMM32Func : u8 {
-        ADDIW           = 0b000
+        ADDIW           = 0b000,
+        SLLIW           = 0b001,
+        SRLIW_SRAIW     = 0b101
+    };
+
+    /* Upper bits of a shift's immediate, telling arithmetic and logical right shifts apart */
+    enum class ShiftFunc : u8 {
+        Logical         = 0b000000,
+        Arithmetic      = 0b010000
     };
 
     enum class STOREFunc : u8 {
@@ -89,13 +182,21 @@ namespace vc::dev::cpu {
 
     enum class LOADFunc : u8 {
         LB              = 0b000,
+        LH              = 0b001,
+        LW              = 0b010,
         LD              = 0b011,
-        LBU             = 0b100
+        LBU             = 0b100,
+        LHU             = 0b101,
+        LWU             = 0b110
     };
 
     enum class BRANCHFunc : u8 {
         BEQ             = 0b000,
-        BNE             = 0b001
+        BNE             = 0b001,
+        BLT             = 0b100,
+        BGE             = 0b101,
+        BLTU            = 0b110,
+        BGEU            = 0b111
     };
 
     union Instruction {
@@ -186,6 +287,7 @@ namespace vc::dev::cpu {
                 instr_t imm12     : 1;
 
                 constexpr u32 getImmediate() const { return ((this->imm12 << 12) | (this->imm11 << 11) | (this->imm5_10 << 5) | (this->imm1_4 << 1)) >> 1; }
+                constexpr void setImmediate(u32 value) { value <<= 1; this->imm12 = value >> 12; this->imm11 = value >> 11; this->imm5_10 = value >> 5; this->imm1_4 = value >> 1; }
             );
 
             INSTRUCTION_FORMAT(U,
@@ -205,6 +307,7 @@ namespace vc::dev::cpu {
                 instr_t imm20     : 1;
 
                 constexpr u32 getImmediate() const { return ((this->imm20 << 20) | (this->imm12_19 << 12) | (this->imm11 << 11) | (this->imm1_10 << 1)) >> 1; }
+                constexpr void setImmediate(u32 value) { value <<= 1; this->imm20 = value >> 20; this->imm12_19 = value >> 12; this->imm11 = value >> 11; this->imm1_10 = value >> 1; }
             );
         } Immediate;
 
@@ -270,6 +373,14 @@ namespace vc::dev::cpu {
             comp_instr_t funct3    : 3;
         );
 
+        COMPRESSED_INSTRUCTION_FORMAT(CA,
+            comp_instr_t opcode    : 2;
+            comp_instr_t rs2       : 3;
+            comp_instr_t funct2    : 2;
+            comp_instr_t rd        : 3;
+            comp_instr_t funct6    : 6;
+        );
+
         COMPRESSED_INSTRUCTION_FORMAT(CB,
             comp_instr_t opcode    : 2;
             comp_instr_t offset1   : 5;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <state.hpp>
+
+#include <optional>
+
 namespace vc::dev::cpu {
 
     class IOPin {
@@ -19,6 +23,18 @@ namespace vc::dev::cpu {
         bool hasValue() {
             return this->value.has_value();
         }
+
+        void clear() {
+            this->value.reset();
+        }
+
+        void saveState(util::StateWriter &state) const {
+            state.write(this->value);
+        }
+
+        void loadState(util::StateReader &state) {
+            state.read(this->value);
+        }
     private:
         std::optional<u8> value;
     };
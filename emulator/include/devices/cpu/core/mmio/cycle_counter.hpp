@@ -0,0 +1,107 @@
+#pragma once
+
+#include <devices/cpu/core/mmio/device.hpp>
+#include <devices/cpu/core/core.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace vc::dev::cpu::mmio {
+
+    /*
+     * Lets firmware measure itself. CYCLE reads the number of instructions the core retired so far, the core executes one per cycle.
+     * Every non-zero value written to REPORT gets recorded as a result for the host to pick up after the run
+     */
+    class CycleCounter : public MMIODevice {
+    public:
+        CycleCounter(u64 base, const Core &core) : MMIODevice("Cycle Counter", base, sizeof(registers)), core(core) {
+
+        }
+
+        [[nodiscard]]
+        u8& byte(u64 offset) noexcept override {
+            this->update();
+            return *(reinterpret_cast<u8*>(&this->registers) + offset);
+        }
+
+        [[nodiscard]]
+        u8 peek(u64 offset) const noexcept override {
+            return *(reinterpret_cast<const u8*>(&this->registers) + offset);
+        }
+
+        [[nodiscard]]
+        u16& halfWord(u64 offset) noexcept override {
+            this->update();
+            return *reinterpret_cast<u16*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        [[nodiscard]]
+        u32& word(u64 offset) noexcept override {
+            this->update();
+            return *reinterpret_cast<u32*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        [[nodiscard]]
+        u64& doubleWord(u64 offset) noexcept override {
+            this->update();
+            return *reinterpret_cast<u64*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        void reset() override {
+            this->registers = { };
+            this->valueChanged = false;
+            this->reports.clear();
+        }
+
+        void saveState(util::StateWriter &state) override {
+            state.write(this->registers);
+            state.write(this->valueChanged);
+            state.writeBytes({ reinterpret_cast<const u8*>(this->reports.data()), this->reports.size() * sizeof(u64) });
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->registers);
+            state.read(this->valueChanged);
+
+            auto bytes = state.readBytes();
+            this->reports.resize(bytes.size() / sizeof(u64));
+            std::memcpy(this->reports.data(), bytes.data(), bytes.size());
+        }
+
+        /* Values the guest reported since the board got started. Only called while the board isn't running */
+        [[nodiscard]]
+        const std::vector<u64>& getReports() const {
+            return this->reports;
+        }
+
+    private:
+        /* Accesses go through references, the counter has to be up to date before every one of them and writes only get seen on the following tick */
+        void update() noexcept {
+            this->registers.CYCLE = this->core.getRetiredInstructions();
+            this->valueChanged = true;
+        }
+
+        void tick() noexcept override {
+            if (this->registers.REPORT != 0) {
+                this->reports.push_back(this->registers.REPORT);
+                this->registers.REPORT = 0;
+            }
+
+            this->valueChanged = false;
+        }
+
+        bool needsUpdate() noexcept override {
+            return this->valueChanged;
+        }
+
+        struct {
+            u64 CYCLE;
+            u64 REPORT;
+        } registers = { };
+
+        const Core &core;
+        bool valueChanged = false;
+        std::vector<u64> reports;
+    };
+
+}
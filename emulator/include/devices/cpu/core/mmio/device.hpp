@@ -1,13 +1,18 @@
 #pragma once
 
 #include <devices/cpu/core/io_pin.hpp>
+#include <dirty_bitmap.hpp>
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace vc::dev::cpu::mmio {
 
     class MMIODevice {
     public:
+        constexpr static inline u64 WatchPageShift = 12;
+
         MMIODevice(std::string_view name, u64 base, size_t size) : name(name), base(base), size(size) { }
 
         constexpr auto operator<=>(const MMIODevice &other) const {
@@ -47,8 +52,47 @@ namespace vc::dev::cpu::mmio {
         [[nodiscard]]
         virtual u64& doubleWord(u64 offset) noexcept = 0;
 
+        /* Reads a byte without any of the side effects a regular access might have */
+        [[nodiscard]]
+        virtual u8 peek(u64 offset) const noexcept = 0;
+
         virtual bool needsUpdate() noexcept { return false; }
 
+        virtual void reset() { }
+        virtual void captureGoldenState() { }
+
+        /* Register state for checkpoints, the contents of memories get tracked page wise by whoever takes the checkpoint */
+        virtual void saveState(util::StateWriter &state) { }
+        virtual void loadState(util::StateReader &state) { }
+
+        /* Write trackers get marked on every write done through the address space. They may only be added or removed while the device isn't running */
+        void addWriteTracker(util::DirtyBitmap &tracker) {
+            this->writeTrackers.push_back(&tracker);
+        }
+
+        void removeWriteTracker(util::DirtyBitmap &tracker) {
+            std::erase(this->writeTrackers, &tracker);
+        }
+
+        /* Gets called right before every store, devices that react to writes of a specific register override it */
+        virtual void markWritten(u64 offset, u64 size) noexcept {
+            for (auto &tracker : this->writeTrackers)
+                tracker->mark(offset, size);
+        }
+
+        /* Pages containing a watchpoint, empty if there are none. Set by the address space while the device isn't running */
+        void setWatchedPages(std::vector<bool> pages) {
+            this->watchedPages = std::move(pages);
+        }
+
+        [[nodiscard]]
+        bool isWatched(u64 offset, u64 size) const noexcept {
+            if (this->watchedPages.empty()) [[likely]]
+                return false;
+
+            return this->watchedPages[offset >> WatchPageShift] || this->watchedPages[(offset + size - 1) >> WatchPageShift];
+        }
+
         [[nodiscard]]
         std::string_view getName() const {
            return this->name;
@@ -60,6 +104,9 @@ namespace vc::dev::cpu::mmio {
         std::string name;
         u64 base;
         u64 size;
+
+        std::vector<util::DirtyBitmap*> writeTrackers;
+        std::vector<bool> watchedPages;
     };
 
 }
\ No newline at end of file
@@ -17,6 +17,11 @@ namespace vc::dev::cpu::mmio {
             return *(reinterpret_cast<u8*>(&this->registers) + offset);
         }
 
+        [[nodiscard]]
+        u8 peek(u64 offset) const noexcept override {
+            return *(reinterpret_cast<const u8*>(&this->registers) + offset);
+        }
+
         [[nodiscard]]
         u16& halfWord(u64 offset) noexcept override {
             return *reinterpret_cast<u16*>((reinterpret_cast<u8*>(&this->registers) + offset));
@@ -32,6 +37,24 @@ namespace vc::dev::cpu::mmio {
             return *reinterpret_cast<u64*>((reinterpret_cast<u8*>(&this->registers) + offset));
         }
 
+        void reset() override {
+            this->registers = { };
+            for (auto &pin : this->gpioPins)
+                pin.clear();
+        }
+
+        void saveState(util::StateWriter &state) override {
+            state.write(this->registers);
+            for (const auto &pin : this->gpioPins)
+                pin.saveState(state);
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->registers);
+            for (auto &pin : this->gpioPins)
+                pin.loadState(state);
+        }
+
         std::array<cpu::IOPin, 8> gpioPins;
 
     private:
@@ -1,39 +1,132 @@
 #pragma once
 
 #include <devices/cpu/core/mmio/device.hpp>
+#include <mapped_memory.hpp>
 
+#include <cstring>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <span>
 
 namespace vc::dev::cpu::mmio {
 
     class Memory : public MMIODevice {
     public:
-        Memory(u64 base, size_t size) : MMIODevice("Internal Memory", base, size) {
-            this->data.resize(size);
-        }
+        Memory(u64 base, size_t size) : MMIODevice("Internal Memory", base, size), data(size) { }
 
         [[nodiscard]]
         u8& byte(u64 offset) noexcept override {
-            return this->data[offset];
+            return this->data.data()[offset];
+        }
+
+        [[nodiscard]]
+        u8 peek(u64 offset) const noexcept override {
+            return this->data.data()[offset];
         }
 
         [[nodiscard]]
         u16& halfWord(u64 offset) noexcept override {
-            return *reinterpret_cast<u16*>(&this->data[offset]);
+            return *reinterpret_cast<u16*>(&this->data.data()[offset]);
         }
 
         [[nodiscard]]
         u32& word(u64 offset) noexcept override {
-            return *reinterpret_cast<u32*>(&this->data[offset]);
+            return *reinterpret_cast<u32*>(&this->data.data()[offset]);
         }
 
         [[nodiscard]]
         u64& doubleWord(u64 offset) noexcept override {
-            return *reinterpret_cast<u64*>(&this->data[offset]);
+            return *reinterpret_cast<u64*>(&this->data.data()[offset]);
+        }
+
+        /* Raw contents for checkpointing. Writing through here bypasses the write trackers */
+        [[nodiscard]]
+        std::span<u8> getData() noexcept {
+            return { this->data.data(), this->data.getSize() };
+        }
+
+        /*
+         * Replaces the contents by an image, e.g. firmware that every board in the process shares. Pages only get copied once they're written to.
+         * Only called while the memory isn't being accessed
+         */
+        bool mapImage(std::shared_ptr<const util::MemoryImage> image) {
+            if (image == nullptr || !this->data.map(*image))
+                return false;
+
+            this->image = std::move(image);
+            if (!this->imageTracker.has_value()) {
+                this->imageTracker.emplace(this->getSize(), ImagePageSize);
+                this->addWriteTracker(*this->imageTracker);
+            }
+
+            this->markWritten(0, this->getSize());
+
+            /* Marking the whole memory for everyone else marked it for us as well */
+            this->imageTracker->clear();
+
+            return true;
+        }
+
+        /* Only pages written since the golden state got captured are copied back from its image, so resetting costs about as much as the last run dirtied */
+        void reset() override {
+            if (this->golden == nullptr)
+                return;
+
+            if (this->image != this->golden) {
+                this->mapImage(this->golden);
+                return;
+            }
+
+            auto memory = this->getData();
+            const auto contents = this->golden->getContents();
+            this->imageTracker->consume([&, this](u64 page) {
+                const auto offset = page * ImagePageSize;
+                const auto size = std::min<u64>(ImagePageSize, memory.size() - offset);
+
+                std::memcpy(memory.data() + offset, contents.data() + offset, size);
+                this->markWritten(offset, size);
+            });
+
+            this->imageTracker->clear();
+        }
+
+        /* Memory that still matches the image it maps uses that image as its golden state, anything else gets captured into an image of its own and mapped from there */
+        void captureGoldenState() override {
+            if (!this->matchesImage() && !this->mapImage(this->data.capture()))
+                log::error("Failed to capture golden state of '{}'", this->getName());
+
+            this->golden = this->image;
+        }
+
+        /* Contents are only part of full snapshots. Boards restored from the same snapshot share all pages until they write to them */
+        void saveState(util::StateWriter &state) override {
+            if (state.capturesMemory())
+                state.writeImage(this->matchesImage() ? this->image : this->data.capture());
+        }
+
+        void loadState(util::StateReader &state) override {
+            if (auto image = state.readImage(); image != nullptr) {
+                if (!this->mapImage(image))
+                    log::error("Failed to map memory image into '{}'", this->getName());
+            }
         }
 
     private:
-        std::vector<u8> data;
+        constexpr static inline u64 ImagePageSize = 4096;
+
+        [[nodiscard]]
+        bool matchesImage() const {
+            return this->image != nullptr && !this->imageTracker->any();
+        }
+
+        util::MappedMemory data;
+
+        /* Image the memory currently maps and the pages that got written since it got mapped */
+        std::shared_ptr<const util::MemoryImage> image;
+        std::optional<util::DirtyBitmap> imageTracker;
+
+        std::shared_ptr<const util::MemoryImage> golden;
     };
 
 }
\ No newline at end of file
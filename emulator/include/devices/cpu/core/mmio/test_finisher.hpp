@@ -0,0 +1,111 @@
+#pragma once
+
+#include <devices/cpu/core/mmio/device.hpp>
+
+#include <atomic>
+#include <optional>
+
+namespace vc::dev::cpu::mmio {
+
+    /*
+     * Lets the guest end a run with an exit code, register compatible with QEMU's sifive_test device.
+     * Writing 0x5555 passes, writing 0x3333 fails with the exit code taken from the upper half of the written word
+     */
+    class TestFinisher : public MMIODevice {
+    public:
+        constexpr static inline u16 Pass = 0x5555;
+        constexpr static inline u16 Fail = 0x3333;
+
+        TestFinisher(u64 base) : MMIODevice("Test Finisher", base, sizeof(u32)) {
+
+        }
+
+        [[nodiscard]]
+        u8& byte(u64 offset) noexcept override {
+            this->valueChanged = true;
+            return *(reinterpret_cast<u8*>(&this->registers) + offset);
+        }
+
+        [[nodiscard]]
+        u8 peek(u64 offset) const noexcept override {
+            return *(reinterpret_cast<const u8*>(&this->registers) + offset);
+        }
+
+        [[nodiscard]]
+        u16& halfWord(u64 offset) noexcept override {
+            this->valueChanged = true;
+            return *reinterpret_cast<u16*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        [[nodiscard]]
+        u32& word(u64 offset) noexcept override {
+            this->valueChanged = true;
+            return *reinterpret_cast<u32*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        [[nodiscard]]
+        u64& doubleWord(u64 offset) noexcept override {
+            this->valueChanged = true;
+            return *reinterpret_cast<u64*>((reinterpret_cast<u8*>(&this->registers) + offset));
+        }
+
+        void reset() override {
+            this->registers = { };
+            this->valueChanged = false;
+            this->finished = false;
+        }
+
+        void saveState(util::StateWriter &state) override {
+            state.write(this->registers);
+            state.write(this->valueChanged);
+            state.write(this->exitCode);
+            state.write(this->finished.load());
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->registers);
+            state.read(this->valueChanged);
+            state.read(this->exitCode);
+            this->finished = state.read<bool>();
+        }
+
+        /* Exit code the guest finished with, nothing while it's still running. Safe to be called from any thread */
+        [[nodiscard]]
+        std::optional<u32> getExitCode() const {
+            if (!this->finished.load(std::memory_order_acquire))
+                return { };
+
+            return this->exitCode;
+        }
+
+    private:
+        void tick() noexcept override {
+            const auto status = u16(this->registers.FINISHER);
+
+            if (status == Pass) {
+                this->exitCode = 0;
+                this->finished.store(true, std::memory_order_release);
+            } else if (status == Fail) {
+                this->exitCode = this->registers.FINISHER >> 16;
+                this->finished.store(true, std::memory_order_release);
+            }
+
+            this->valueChanged = false;
+        }
+
+        bool needsUpdate() noexcept override {
+            return this->valueChanged;
+        }
+
+        /* Padded so the double word accessor stays inside the registers, the device only maps the first word */
+        struct {
+            u32 FINISHER;
+            u32 reserved;
+        } registers = { };
+
+        bool valueChanged = false;
+        u32 exitCode = 0;
+        std::atomic<bool> finished = false;
+    };
+
+}
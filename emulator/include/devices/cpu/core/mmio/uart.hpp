@@ -2,6 +2,7 @@
 
 #include <devices/cpu/core/mmio/device.hpp>
 
+#include <cstddef>
 #include <numeric>
 
 namespace vc::dev::cpu::mmio {
@@ -14,49 +15,92 @@ namespace vc::dev::cpu::mmio {
 
         [[nodiscard]]
         u8& byte(u64 offset) noexcept override {
-            this->valueChanged = true;
             return *(reinterpret_cast<u8*>(&this->registers) + offset);
         }
 
+        [[nodiscard]]
+        u8 peek(u64 offset) const noexcept override {
+            return *(reinterpret_cast<const u8*>(&this->registers) + offset);
+        }
+
         [[nodiscard]]
         u16& halfWord(u64 offset) noexcept override {
-            this->valueChanged = true;
             return *reinterpret_cast<u16*>((reinterpret_cast<u8*>(&this->registers) + offset));
         }
 
         [[nodiscard]]
         u32& word(u64 offset) noexcept override {
-            this->valueChanged = true;
             return *reinterpret_cast<u32*>((reinterpret_cast<u8*>(&this->registers) + offset));
         }
 
         [[nodiscard]]
         u64& doubleWord(u64 offset) noexcept override {
-            this->valueChanged = true;
             return *reinterpret_cast<u64*>((reinterpret_cast<u8*>(&this->registers) + offset));
         }
 
-        cpu::IOPin txPin;
+        /* Only a store to TX sends a byte, reading RX or CR mustn't put anything on the line */
+        void markWritten(u64 offset, u64 size) noexcept override {
+            MMIODevice::markWritten(offset, size);
+
+            constexpr static u64 TXOffset = offsetof(Registers, TX);
+            if (offset < TXOffset + sizeof(Registers::TX) && offset + size > TXOffset)
+                this->valueChanged = true;
+        }
+
+        void reset() override {
+            this->registers = { };
+            this->valueChanged = false;
+            this->receivedCount = 0;
+            this->txPin.clear();
+            this->rxPin.clear();
+        }
+
+        void saveState(util::StateWriter &state) override {
+            state.write(this->registers);
+            state.write(this->valueChanged);
+            state.write(this->receivedCount);
+            this->txPin.saveState(state);
+            this->rxPin.saveState(state);
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->registers);
+            state.read(this->valueChanged);
+            state.read(this->receivedCount);
+            this->txPin.loadState(state);
+            this->rxPin.loadState(state);
+        }
+
+        cpu::IOPin txPin, rxPin;
 
     private:
 
         void tick() noexcept override {
-            txPin.setValue(static_cast<u8>(registers.TX));
-            registers.TX = 0x00;
-            this->valueChanged = false;
+            if (this->valueChanged) {
+                txPin.setValue(static_cast<u8>(registers.TX));
+                registers.TX = 0x00;
+                this->valueChanged = false;
+            }
+
+            /* RX holds the most recently received byte and the number of bytes received so far in its upper half */
+            if (rxPin.hasValue()) {
+                this->receivedCount++;
+                registers.RX = (u32(this->receivedCount) << 16) | rxPin.getValue().value();
+            }
         }
 
         bool needsUpdate() noexcept override {
-            return this->valueChanged;
+            return this->valueChanged || this->rxPin.hasValue();
         }
 
-        struct {
+        struct Registers {
             u32 CR;
             u32 TX;
             u32 RX;
         } registers;
 
         bool valueChanged = false;
+        u16 receivedCount = 0;
     };
 
 }
\ No newline at end of file
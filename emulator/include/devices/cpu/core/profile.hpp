@@ -0,0 +1,132 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vc::dev::cpu {
+
+    /*
+     * Samples the program counter of a single core every few instructions together with the call stack it was reached through.
+     * The call stack gets tracked from the return address hints of JAL and JALR, so no memory ever has to be walked, and lives in a tree of call sites:
+     * every stack that ever existed is a node, a sample only stores the node and its program counter.
+     * Only touched by the core while it's running, read once it stopped
+     */
+    class Profile {
+    public:
+        constexpr static inline u32 MaxDepth = 512;
+        constexpr static inline u32 RootNode = 0;
+
+        struct Node {
+            u32 parent;
+            u64 callSite;
+        };
+
+        struct Sample {
+            u32 node;
+            u64 pc;
+
+            constexpr bool operator==(const Sample &other) const = default;
+        };
+
+        struct SampleHash {
+            size_t operator()(const Sample &sample) const {
+                return std::hash<u64>()(sample.pc ^ (u64(sample.node) << 40));
+            }
+        };
+
+        explicit Profile(u32 interval) : interval(std::max(interval, 1U)), countdown(this->interval) {
+            this->nodes.push_back({ RootNode, 0 });
+        }
+
+        /* Called for every retired instruction, only every interval-th one gets recorded */
+        void retire(u64 pc) {
+            if (--this->countdown != 0) [[likely]]
+                return;
+
+            this->countdown = this->interval;
+            this->sample(pc);
+        }
+
+        /* Jump from pc with link register rd. rs1 only exists for indirect jumps, following the return address stack hints of the specification */
+        void jump(u64 pc, u8 rd, std::optional<u8> rs1) {
+            const bool linkRd = isLink(rd), linkRs1 = rs1.has_value() && isLink(*rs1);
+
+            /* The jump itself still belongs to the stack it got executed in. Its retire right after mustn't sample a second time */
+            if (this->countdown == 1) [[unlikely]] {
+                this->countdown = this->interval + 1;
+                this->sample(pc);
+            }
+
+            if (linkRs1 && (!linkRd || rd != *rs1))
+                this->leave();
+            if (linkRd)
+                this->enter(pc);
+        }
+
+        [[nodiscard]]
+        u32 getInterval() const {
+            return this->interval;
+        }
+
+        [[nodiscard]]
+        u64 getSampleCount() const {
+            return this->sampleCount;
+        }
+
+        [[nodiscard]]
+        const std::vector<Node>& getNodes() const {
+            return this->nodes;
+        }
+
+        [[nodiscard]]
+        const std::unordered_map<Sample, u64, SampleHash>& getSamples() const {
+            return this->samples;
+        }
+
+    private:
+        [[nodiscard]]
+        constexpr static bool isLink(u8 reg) {
+            return reg == 1 || reg == 5;
+        }
+
+        void sample(u64 pc) {
+            this->samples[{ this->node, pc }]++;
+            this->sampleCount++;
+        }
+
+        /* Calls deeper than MaxDepth still get counted so returns stay balanced, they just don't get a node of their own */
+        void enter(u64 callSite) {
+            if (this->depth++ >= MaxDepth)
+                return;
+
+            auto [child, inserted] = this->children.try_emplace({ this->node, callSite }, u32(this->nodes.size()));
+            if (inserted)
+                this->nodes.push_back({ this->node, callSite });
+
+            this->node = child->second;
+        }
+
+        /* Returns without a matching call, e.g. from the function the profile started in, get ignored */
+        void leave() {
+            if (this->depth == 0)
+                return;
+
+            if (--this->depth < MaxDepth)
+                this->node = this->nodes[this->node].parent;
+        }
+
+        u32 interval, countdown;
+        u32 node = RootNode, depth = 0;
+        u64 sampleCount = 0;
+
+        std::vector<Node> nodes;
+        std::unordered_map<Sample, u32, SampleHash> children;
+        std::unordered_map<Sample, u64, SampleHash> samples;
+    };
+
+}
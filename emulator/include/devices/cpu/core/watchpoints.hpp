@@ -0,0 +1,128 @@
+#pragma once
+
+#include <risc.hpp>
+#include <counter.hpp>
+#include <ring_buffer.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <vector>
+
+namespace vc::dev::cpu {
+
+    enum class WatchpointType : u8 {
+        Read    = 0b01,
+        Write   = 0b10,
+        Access  = Read | Write
+    };
+
+    enum class WatchpointAction : u8 {
+        /* Stops the hart in front of the instruction doing the access */
+        Stop,
+        /* Logs the access and lets the hart continue */
+        Record
+    };
+
+    struct Watchpoint {
+        u64 address, size;
+        WatchpointType type;
+        WatchpointAction action;
+
+        [[nodiscard]]
+        bool matches(u64 accessAddress, u64 accessSize, WatchpointType access) const {
+            return (u8(this->type) & u8(access)) != 0 && accessAddress < this->address + this->size && this->address < accessAddress + accessSize;
+        }
+    };
+
+    struct WatchpointHit {
+        u64 pc, address, value;
+        u8 size;
+
+        /* Kind of access that got made and kind of the watchpoint that caught it */
+        WatchpointType access, watchpoint;
+    };
+
+    /*
+     * Data watchpoints of an address space. The address space only looks at them for accesses to pages that contain at least one watchpoint.
+     * Watchpoints may only be modified while the cores using them aren't running, hits get recorded from the simulation thread and may be drained from one other thread
+     */
+    class Watchpoints {
+    public:
+        constexpr static inline size_t HitCapacity = 4096;
+
+        Watchpoints() : hits(HitCapacity) { }
+
+        void add(const Watchpoint &watchpoint) {
+            this->watchpoints.push_back(watchpoint);
+        }
+
+        void remove(u64 address, u64 size, WatchpointType type, WatchpointAction action) {
+            std::erase_if(this->watchpoints, [&](const Watchpoint &watchpoint) {
+                return watchpoint.address == address && watchpoint.size == size && watchpoint.type == type && watchpoint.action == action;
+            });
+        }
+
+        void remove(WatchpointAction action) {
+            std::erase_if(this->watchpoints, [&](const Watchpoint &watchpoint) { return watchpoint.action == action; });
+        }
+
+        void clear() {
+            this->watchpoints.clear();
+        }
+
+        [[nodiscard]]
+        const std::vector<Watchpoint>& get() const {
+            return this->watchpoints;
+        }
+
+        /* Watchpoints that stop the hart take precedence over ones that only record the access */
+        [[nodiscard]]
+        const Watchpoint* find(u64 address, u64 size, WatchpointType access) const {
+            const Watchpoint *result = nullptr;
+
+            for (const auto &watchpoint : this->watchpoints) {
+                if (!watchpoint.matches(address, size, access))
+                    continue;
+
+                if (watchpoint.action == WatchpointAction::Stop)
+                    return &watchpoint;
+
+                result = &watchpoint;
+            }
+
+            return result;
+        }
+
+        void record(const WatchpointHit &hit) {
+            if (!this->hits.push(hit))
+                this->droppedHits.add();
+        }
+
+        [[nodiscard]]
+        std::optional<WatchpointHit> popHit() {
+            return this->hits.pop();
+        }
+
+        /* Number of hits that didn't fit into the buffer because nobody drained it */
+        [[nodiscard]]
+        u64 getDroppedHits() const {
+            return this->droppedHits.get();
+        }
+
+    private:
+        std::vector<Watchpoint> watchpoints;
+
+        util::RingBuffer<WatchpointHit> hits;
+        util::Counter droppedHits;
+    };
+
+    /* Thrown by the address space when an access hits a watchpoint, the instruction doing it hasn't changed any state yet */
+    struct WatchpointException : public std::exception {
+        WatchpointException(const WatchpointHit &hit, WatchpointAction action) : hit(hit), action(action) { }
+
+        WatchpointHit hit;
+        WatchpointAction action;
+    };
+
+}
@@ -1,18 +1,21 @@
 #pragma once
 
 #include <devices/device.hpp>
+#include <board/track.hpp>
 #include <devices/cpu/core/core.hpp>
 #include <devices/cpu/core/io_pin.hpp>
 
+#include <algorithm>
 #include <array>
 
 #include <utils.hpp>
+#include <triple_buffer.hpp>
 
 namespace vc::dev {
 
     class CPUDevice : public vc::dev::Device, public pcb::Connectable {
     public:
-        explicit CPUDevice(u32 numCores, ImVec2 pos) {
+        explicit CPUDevice(u32 numCores, pcb::Vec2 pos) {
             for (u32 i = 0; i < numCores; i++)
                 this->cores.emplace_back(addressSpace);
 
@@ -42,10 +45,7 @@ namespace vc::dev {
                 }
             }
 
-            for (auto &[trackName, pinNumber] : this->pinToTrackConnections) {
-                auto &pin = this->pins[pinNumber];
-                auto track = this->getTrack(trackName);
-
+            for (auto &[pin, track] : this->pinConnections) {
                 if (track->getDirection() == pcb::Direction::MOSI && pin->hasValue()) {
                     track->setValue(pin->getValue().value());
                 }
@@ -68,31 +68,87 @@ namespace vc::dev {
         void reset() override {
             for (auto &core : this->cores)
                 core.reset();
+            for (auto &device : this->addressSpace.getDevices())
+                device->reset();
         }
 
-        auto& getAddressSpace() {
-            return this->addressSpace;
+        void captureGoldenState() override {
+            for (auto &device : this->addressSpace.getDevices())
+                device->captureGoldenState();
         }
 
-        void draw(ImVec2 start, ImDrawList *drawList) override {
-            drawList->AddRectFilled(start + getPosition(), start + getPosition() + getSize(), ImColor(0x10, 0x10, 0x10, 0xFF));
-            drawList->AddText(start + getPosition() + ImVec2(10, 10), ImColor(0xFFFFFFFF), fmt::format("RISC-V\n {} Core", this->cores.size()).c_str());
+        [[nodiscard]]
+        bool isClockDomain() const override { return true; }
 
-            if (ImGui::IsMouseHoveringRect(start + getPosition(), start + getPosition() + getSize())) {
-                ImGui::BeginTooltip();
-                if (this->needsUpdate())
-                    ImGui::TextSpinner("Running...");
-                else
-                    ImGui::TextUnformatted("Halted");
+        void saveState(util::StateWriter &state) override {
+            for (auto &core : this->cores)
+                core.saveState(state);
+            for (auto &device : this->addressSpace.getDevices())
+                device->saveState(state);
+        }
 
-                ImGui::Separator();
+        void loadState(util::StateReader &state) override {
+            for (auto &core : this->cores)
+                core.loadState(state);
+            for (auto &device : this->addressSpace.getDevices())
+                device->loadState(state);
+        }
 
-                for (auto &device : this->getAddressSpace().getDevices()) {
-                    ImGui::TextUnformatted(fmt::format("{}: 0x{:016X} - 0x{:016X}", device->getName(), device->getBase(), device->getEnd()).c_str());
-                }
+        [[nodiscard]]
+        bool wantsPause() const override {
+            return std::any_of(this->cores.begin(), this->cores.end(), [](const cpu::Core &core) { return core.isDebugStopped(); });
+        }
 
-                ImGui::EndTooltip();
+        struct CoreState {
+            bool halted;
+            u64 pc;
+        };
+
+        /* Program counters always get published for the disassembly, only cores halting or starting change what's drawn on the board */
+        bool publishState() override {
+            auto &state = this->coreStates.getWriteBuffer();
+            state.resize(this->cores.size());
+
+            bool changed = this->publishedHalted.size() != this->cores.size();
+            this->publishedHalted.resize(this->cores.size());
+
+            for (u32 i = 0; i < this->cores.size(); i++) {
+                state[i] = { this->cores[i].isHalted(), this->cores[i].getPC() };
+
+                if (this->publishedHalted[i] != state[i].halted) {
+                    this->publishedHalted[i] = state[i].halted;
+                    changed = true;
+                }
             }
+
+            this->coreStates.publish();
+
+            return changed;
+        }
+
+        /* Most recently published state of all cores, safe to be called from the UI thread */
+        [[nodiscard]]
+        const std::vector<CoreState>& getCoreStates() {
+            return this->coreStates.read();
+        }
+
+        [[nodiscard]]
+        cpu::Core& getCore(u32 index) {
+            return this->cores[index];
+        }
+
+        [[nodiscard]]
+        u32 getCoreCount() const {
+            return this->cores.size();
+        }
+
+        [[nodiscard]]
+        u64 getRetiredInstructions(u32 core) const {
+            return this->cores[core].getRetiredInstructions();
+        }
+
+        auto& getAddressSpace() {
+            return this->addressSpace;
         }
 
         void attachToPin(u32 pinNumber, cpu::IOPin &pin) {
@@ -100,14 +156,40 @@ namespace vc::dev {
         }
 
         void attachPinToTrack(u32 pinNumber, std::string_view trackName) {
-            this->pinToTrackConnections[std::string(trackName)] = pinNumber;
+            this->pinToTrackNames.emplace_back(trackName, pinNumber);
+        }
+
+    protected:
+        void elaborate() override {
+            this->pinConnections.clear();
+
+            for (const auto &[trackName, pinNumber] : this->pinToTrackNames) {
+                auto pin = this->pins.find(pinNumber);
+                auto track = this->getTrack(trackName);
+
+                if (pin == this->pins.end() || track == nullptr) {
+                    log::error("Failed to connect pin {} to track '{}'", pinNumber, trackName);
+                    continue;
+                }
+
+                this->pinConnections.push_back({ pin->second, track });
+            }
         }
 
     private:
+        struct PinConnection {
+            cpu::IOPin *pin;
+            pcb::Track *track;
+        };
+
         cpu::AddressSpace addressSpace;
         std::vector<cpu::Core> cores;
         std::map<u32, cpu::IOPin*> pins;
-        std::map<std::string, u32> pinToTrackConnections;
+        std::vector<std::pair<std::string, u32>> pinToTrackNames;
+        std::vector<PinConnection> pinConnections;
+
+        util::TripleBuffer<std::vector<CoreState>> coreStates;
+        std::vector<bool> publishedHalted;
     };
 
 }
\ No newline at end of file
@@ -1,9 +1,6 @@
 #pragma once
 
-#include <imgui.h>
-#define IMGUI_DEFINE_MATH_OPERATORS
-#include <imgui_internal.h>
-#include <imgui_vc_extensions.h>
+#include <state.hpp>
 
 namespace vc::dev {
 
@@ -15,6 +12,30 @@ namespace vc::dev {
         virtual void tick() = 0;
         virtual bool needsUpdate() = 0;
         virtual void reset() = 0;
+
+        /*
+         * Called by the simulation to hand the UI visible state of the device over to the UI thread.
+         * Returns true if anything drawn on the board changed since the last publish, state only read by dedicated views doesn't count
+         */
+        virtual bool publishState() { return false; }
+
+        /* Simulation state for checkpoints. Only called between two windows of virtual time while no partition is running */
+        virtual void saveState(util::StateWriter &state) { }
+        virtual void loadState(util::StateReader &state) { }
+
+        /* Remembers the current contents of memories so the next reset() only has to undo what got changed since */
+        virtual void captureGoldenState() { }
+
+        /* Applies an input event coming from outside of the simulation. Always runs on the simulation side */
+        virtual void applyInput(u32 channel, u64 value) { }
+
+        /* Devices with their own clock domain get simulated in a partition of their own, independent of the rest of the board */
+        [[nodiscard]]
+        virtual bool isClockDomain() const { return false; }
+
+        /* Devices that got stopped by a debugger keep the whole board paused at the next window boundary */
+        [[nodiscard]]
+        virtual bool wantsPause() const { return false; }
     };
 
 }
\ No newline at end of file
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <board/track.hpp>
+#include <triple_buffer.hpp>
 
 namespace vc::dev {
 
     class LED : public Device, public pcb::Connectable {
     public:
-        explicit LED(ImVec2 pos) {
+        explicit LED(pcb::Vec2 pos) {
             this->setPosition(pos);
             this->setSize({ 20, 10 });
         }
@@ -16,9 +17,7 @@ namespace vc::dev {
         }
 
         void tick() override {
-            for (auto &trackName : this->getConnectedTrackNames()) {
-                auto track = this->getTrack(trackName);
-
+            for (auto &track : this->getConnectedTracks()) {
                 if (track->hasValue())
                     glowing = track->getValue().value();
             }
@@ -29,13 +28,34 @@ namespace vc::dev {
             glowing = false;
         }
 
-        void draw(ImVec2 start, ImDrawList *drawList) override {
-            drawList->AddRectFilled(start + getPosition(), start + getPosition() + getSize(), ImColor(0xA0, 0xA0, 0xA0, 0xFF));
-            drawList->AddRectFilled(start + getPosition() + ImVec2(5, 0), start + getPosition() + getSize() - ImVec2(5, 0), glowing ? ImColor(0xA0, 0x10, 0x10, 0xFF) : ImColor(0x30, 0x10, 0x10, 0xFF));
+        void saveState(util::StateWriter &state) override {
+            state.write(this->glowing);
+        }
+
+        void loadState(util::StateReader &state) override {
+            state.read(this->glowing);
+        }
+
+        bool publishState() override {
+            if (this->glowing == this->publishedGlowing)
+                return false;
+
+            this->publishedGlowing = this->glowing;
+            this->glowingState.getWriteBuffer() = this->glowing;
+            this->glowingState.publish();
+
+            return true;
+        }
+
+        /* Most recently published state, safe to be called from the UI thread */
+        [[nodiscard]]
+        bool isGlowing() {
+            return this->glowingState.read();
         }
 
     private:
-        bool glowing = false;
+        bool glowing = false, publishedGlowing = false;
+        util::TripleBuffer<bool> glowingState;
     };
 
 }
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <board/track.hpp>
+#include <triple_buffer.hpp>
+
+#include <deque>
 
 namespace vc::dev {
 
     class PinHeader : public Device, public pcb::Connectable {
     public:
-        explicit PinHeader(ImVec2 pos) {
+        explicit PinHeader(pcb::Vec2 pos) {
             this->setPosition(pos);
         }
 
@@ -14,42 +17,120 @@ namespace vc::dev {
             return this->getTrack(name);
         }
 
-        void tick() override { }
-        bool needsUpdate() override { return this->dataAvailable(); }
-        void reset() override {
-            this->receivedData.clear();
-        }
+        void tick() override {
+            for (u32 slot = 0; slot < this->receivedData.size(); slot++) {
+                auto track = this->getConnectedTracks()[slot];
 
-        void draw(ImVec2 start, ImDrawList *drawList) override {
-            this->numPins = this->getConnectedTrackNames().size();
-            this->setSize({ 19.0F * this->numPins, 19.0F });
+                if (this->drives(track)) {
+                    if (!this->sendQueue[slot].empty()) {
+                        track->setValue(this->sendQueue[slot].front());
+                        this->sendQueue[slot].pop_front();
+                    }
+
+                    continue;
+                }
 
-            drawList->AddRectFilled(start + getPosition(), start + getPosition() + getSize(), ImColor(0x10, 0x10, 0x10, 0xFF));
+                auto c = track->getValue();
+                if (c.has_value()) {
+                    auto &data = this->receivedData[slot];
+                    data += (char)*c;
 
-            for (auto i = 0; i < this->numPins; i++) {
-                drawList->AddCircleFilled(ImVec2(start + getPosition() + ImVec2(9 + 19 * i, 10)), 4, ImColor(0xB0, 0xB0, 0xC0, 0xFF));
+                    /* Trimmed in chunks so every byte costs the same no matter how long the board has been running */
+                    if (data.size() > 2 * HistorySize)
+                        data.erase(0, data.size() - HistorySize);
+
+                    this->dataChanged = true;
+                }
             }
+        }
 
-            for (auto &trackName : this->getConnectedTrackNames()) {
-                auto c = this->get(trackName)->getValue();
-                if (c.has_value())
-                    receivedData[std::string(trackName)] += (char)*c;
+        bool needsUpdate() override {
+            return this->dataAvailable() || std::any_of(this->sendQueue.begin(), this->sendQueue.end(), [](const auto &queue) { return !queue.empty(); });
+        }
+
+        void reset() override {
+            for (auto &data : this->receivedData)
+                data.clear();
+            for (auto &queue : this->sendQueue)
+                queue.clear();
+            this->dataChanged = true;
+        }
+
+        /* Received data is only shown to the user and stays out of the simulation state, only bytes still waiting to be sent are part of it */
+        void saveState(util::StateWriter &state) override {
+            for (const auto &queue : this->sendQueue)
+                state.writeBytes(std::vector<u8>(queue.begin(), queue.end()));
+        }
+
+        void loadState(util::StateReader &state) override {
+            for (auto &queue : this->sendQueue) {
+                auto bytes = state.readBytes();
+                queue.assign(bytes.begin(), bytes.end());
             }
+        }
+
+        /* Bytes typed in by the user, sent out one per tick on the track in the given slot */
+        void applyInput(u32 slot, u64 value) override {
+            if (slot < this->sendQueue.size())
+                this->sendQueue[slot].push_back(u8(value));
+        }
+
+        void elaborate() override {
+            this->receivedData.resize(this->getConnectedTracks().size());
+            this->sendQueue.resize(this->getConnectedTracks().size());
 
-            if (ImGui::IsMouseHoveringRect(start + getPosition(), start + getPosition() + getSize())) {
-                ImGui::BeginTooltip();
-                ImGui::TextUnformatted("Connected Tracks");
-                ImGui::Separator();
-                for (auto &trackName : this->getConnectedTrackNames()) {
-                    ImGui::Text("%s: %s", trackName.data(), receivedData[std::string(trackName)].c_str());
+            this->inputSlot.reset();
+            for (u32 slot = 0; slot < this->getConnectedTracks().size(); slot++) {
+                if (this->drives(this->getConnectedTracks()[slot])) {
+                    this->inputSlot = slot;
+                    break;
                 }
-                ImGui::EndTooltip();
             }
         }
 
+        bool publishState() override {
+            if (!this->dataChanged) return false;
+
+            this->receivedDataState.getWriteBuffer() = this->receivedData;
+            this->receivedDataState.publish();
+            this->dataChanged = false;
+
+            return true;
+        }
+
+        void layout() override {
+            this->setSize({ 19.0F * this->getConnectedTracks().size(), 19.0F });
+        }
+
+        /* Most recently published data received on every track, at least the last HistorySize bytes of it. Safe to be called from the UI thread */
+        [[nodiscard]]
+        const std::vector<std::string>& getReceivedData() {
+            return this->receivedDataState.read();
+        }
+
+        /* Slot of the track typed in input gets sent out on, nothing if the header doesn't drive any track */
+        [[nodiscard]]
+        std::optional<u32> getInputSlot() const {
+            return this->inputSlot;
+        }
+
+        constexpr static inline size_t HistorySize = 4096;
+
     private:
-        u32 numPins = 1;
-        std::map<std::string, std::string> receivedData;
+        [[nodiscard]]
+        bool drives(const pcb::Track *track) const {
+            auto [from, to] = track->getEndpoints();
+            return track->getDirection() == pcb::Direction::MOSI ? from == this : to == this;
+        }
+
+        std::vector<std::string> receivedData;
+        bool dataChanged = false;
+        util::TripleBuffer<std::vector<std::string>> receivedDataState;
+
+        /* Only touched by the simulation */
+        std::vector<std::deque<u8>> sendQueue;
+
+        std::optional<u32> inputSlot;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <board/track.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace vc::dev {
+
+    /* Writes every byte it receives on its tracks to a file, e.g. stdout when running without a window, and optionally keeps a copy of everything it received */
+    class SerialConsole : public Device, public pcb::Connectable {
+    public:
+        explicit SerialConsole(pcb::Vec2 pos) {
+            this->setPosition(pos);
+            this->setSize({ 20, 20 });
+        }
+
+        /* Only set while the board isn't running */
+        void setOutput(FILE *file) {
+            this->output = file;
+        }
+
+        /* Only set while the board isn't running */
+        void setCapture(bool enabled) {
+            this->capture = enabled;
+        }
+
+        [[nodiscard]]
+        bool isCapturing() const {
+            return this->capture;
+        }
+
+        /* Everything received since the last reset while capturing. Only called between two windows of virtual time */
+        [[nodiscard]]
+        const std::string& getCapturedOutput() const {
+            return this->captured;
+        }
+
+        void tick() override {
+            for (auto &track : this->getConnectedTracks()) {
+                auto c = track->getValue();
+                if (!c.has_value())
+                    continue;
+
+                if (this->capture)
+                    this->captured += char(*c);
+
+                if (this->output == nullptr)
+                    continue;
+
+                std::fputc(*c, this->output);
+                if (*c == '\n')
+                    std::fflush(this->output);
+            }
+        }
+
+        bool needsUpdate() override {
+            return this->dataAvailable();
+        }
+
+        void reset() override {
+            this->captured.clear();
+        }
+
+        /* The capture is only ever appended to, so its length is all the state there is. Going back in time cuts off what got received since */
+        void saveState(util::StateWriter &state) override {
+            state.write<u64>(this->captured.size());
+        }
+
+        void loadState(util::StateReader &state) override {
+            this->captured.resize(std::min<u64>(state.read<u64>(), this->captured.size()));
+        }
+
+    private:
+        FILE *output = stdout;
+
+        bool capture = false;
+        std::string captured;
+    };
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace vc::util {
+
+    /*
+     * One bit per page of a memory region, set whenever something gets written to that page.
+     * Marking may happen from one thread while another one tests and clears pages. Marking only does a read-modify-write
+     * the first time a page gets dirty, so tracking a page that's written to in a loop costs a single relaxed load per write
+     */
+    class DirtyBitmap {
+    public:
+        explicit DirtyBitmap(u64 size, u64 pageSize = 4096)
+            : pageShift(std::countr_zero(std::bit_ceil(pageSize))), pageCount((size + (u64(1) << this->pageShift) - 1) >> this->pageShift),
+              words(new std::atomic<u64>[(this->pageCount + 63) / 64]) {
+            this->clear();
+        }
+
+        DirtyBitmap(const DirtyBitmap&) = delete;
+        DirtyBitmap& operator=(const DirtyBitmap&) = delete;
+
+        void mark(u64 offset, u64 size = 1) {
+            const auto first = offset >> this->pageShift;
+            const auto last = (offset + size - 1) >> this->pageShift;
+
+            for (auto page = first; page <= last && page < this->pageCount; page++) {
+                auto &word = this->words[page / 64];
+                const auto bit = u64(1) << (page % 64);
+
+                if ((word.load(std::memory_order_relaxed) & bit) == 0)
+                    word.fetch_or(bit, std::memory_order_release);
+            }
+        }
+
+        [[nodiscard]]
+        bool isDirty(u64 page) const {
+            return (this->words[page / 64].load(std::memory_order_acquire) & (u64(1) << (page % 64))) != 0;
+        }
+
+        [[nodiscard]]
+        bool any() const {
+            for (u64 i = 0; i < (this->pageCount + 63) / 64; i++) {
+                if (this->words[i].load(std::memory_order_relaxed) != 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        /* Returns whether the page was dirty and marks it as clean again */
+        bool testAndClear(u64 page) {
+            auto &word = this->words[page / 64];
+            const auto bit = u64(1) << (page % 64);
+
+            if ((word.load(std::memory_order_relaxed) & bit) == 0)
+                return false;
+
+            return (word.fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+        }
+
+        /* Calls the callback with the index of every dirty page and marks them as clean again. Clean runs of 64 pages only cost a single load */
+        template<typename F>
+        void consume(F callback) {
+            for (u64 i = 0; i < (this->pageCount + 63) / 64; i++) {
+                if (this->words[i].load(std::memory_order_relaxed) == 0) continue;
+
+                auto dirty = this->words[i].exchange(0, std::memory_order_acq_rel);
+                while (dirty != 0) {
+                    callback(i * 64 + std::countr_zero(dirty));
+                    dirty &= dirty - 1;
+                }
+            }
+        }
+
+        void clear() {
+            for (u64 i = 0; i < (this->pageCount + 63) / 64; i++)
+                this->words[i].store(0, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]]
+        u64 getPageSize() const {
+            return u64(1) << this->pageShift;
+        }
+
+        [[nodiscard]]
+        u64 getPageCount() const {
+            return this->pageCount;
+        }
+
+        [[nodiscard]]
+        u64 getPage(u64 offset) const {
+            return offset >> this->pageShift;
+        }
+
+    private:
+        u32 pageShift;
+        u64 pageCount;
+        std::unique_ptr<std::atomic<u64>[]> words;
+    };
+
+}
@@ -3,43 +3,39 @@
 #include <fmt/core.h>
 #include <fmt/color.h>
 
+/* Log output goes to stderr so it never mixes with guest output streamed to stdout */
 namespace vc::log {
 
     void debug(std::string_view fmt, auto ... args) {
 #if defined(DEBUG)
-        fmt::print(fg(fmt::color::green_yellow) | fmt::emphasis::bold, "[DEBUG] ");
-        fmt::print(fmt, args...);
-        fmt::print("\n");
-        fflush(stdout);
+        fmt::print(stderr, fg(fmt::color::green_yellow) | fmt::emphasis::bold, "[DEBUG] ");
+        fmt::print(stderr, fmt::runtime(fmt), args...);
+        fmt::print(stderr, "\n");
 #endif
     }
 
     void info(std::string_view fmt, auto ... args) {
-        fmt::print(fg(fmt::color::cornflower_blue) | fmt::emphasis::bold, "[INFO]  ");
-        fmt::print(fmt, args...);
-        fmt::print("\n");
-        fflush(stdout);
+        fmt::print(stderr, fg(fmt::color::cornflower_blue) | fmt::emphasis::bold, "[INFO]  ");
+        fmt::print(stderr, fmt::runtime(fmt), args...);
+        fmt::print(stderr, "\n");
     }
 
     void warn(std::string_view fmt, auto ... args) {
-        fmt::print(fg(fmt::color::light_golden_rod_yellow) | fmt::emphasis::bold, "[WARN]  ");
-        fmt::print(fmt, args...);
-        fmt::print("\n");
-        fflush(stdout);
+        fmt::print(stderr, fg(fmt::color::light_golden_rod_yellow) | fmt::emphasis::bold, "[WARN]  ");
+        fmt::print(stderr, fmt::runtime(fmt), args...);
+        fmt::print(stderr, "\n");
     }
 
     void error(std::string_view fmt, auto ... args) {
-        fmt::print(fg(fmt::color::light_coral) | fmt::emphasis::bold, "[ERROR] ");
-        fmt::print(fmt, args...);
-        fmt::print("\n");
-        fflush(stdout);
+        fmt::print(stderr, fg(fmt::color::light_coral) | fmt::emphasis::bold, "[ERROR] ");
+        fmt::print(stderr, fmt::runtime(fmt), args...);
+        fmt::print(stderr, "\n");
     }
 
     void fatal(std::string_view fmt, auto ... args) {
-        fmt::print(fg(fmt::color::crimson) | fmt::emphasis::bold, "[FATAL] ");
-        fmt::print(fmt, args...);
-        fmt::print("\n");
-        fflush(stdout);
+        fmt::print(stderr, fg(fmt::color::crimson) | fmt::emphasis::bold, "[FATAL] ");
+        fmt::print(stderr, fmt::runtime(fmt), args...);
+        fmt::print(stderr, "\n");
     }
 
 }
\ No newline at end of file
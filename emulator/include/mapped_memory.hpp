@@ -0,0 +1,128 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace vc::util {
+
+    /*
+     * Immutable copy of a block of memory, kept in an anonymous file so any number of MappedMemory instances can map it copy-on-write.
+     * Pages that only contain zeros never get written into the file and don't take up any space. Everyone mapping the image shares the same physical pages
+     */
+    class MemoryImage {
+    public:
+        explicit MemoryImage(std::span<const u8> contents) : size(contents.size()) {
+            this->handle = memfd_create("vc-memory-image", MFD_CLOEXEC);
+            if (this->handle < 0 || ftruncate(this->handle, this->size) != 0)
+                throw std::bad_alloc();
+
+            const auto pageSize = u64(sysconf(_SC_PAGESIZE));
+            for (u64 offset = 0; offset < this->size; offset += pageSize) {
+                const auto page = contents.subspan(offset, std::min<u64>(pageSize, this->size - offset));
+                if (std::all_of(page.begin(), page.end(), [](u8 byte) { return byte == 0x00; }))
+                    continue;
+
+                if (pwrite(this->handle, page.data(), page.size(), offset) != ssize_t(page.size()))
+                    throw std::bad_alloc();
+            }
+
+            auto mapping = mmap(nullptr, std::max<size_t>(this->size, 1), PROT_READ, MAP_SHARED, this->handle, 0);
+            if (mapping == MAP_FAILED)
+                throw std::bad_alloc();
+
+            this->contents = static_cast<const u8*>(mapping);
+        }
+
+        ~MemoryImage() {
+            munmap(const_cast<u8*>(this->contents), std::max<size_t>(this->size, 1));
+            close(this->handle);
+        }
+
+        MemoryImage(const MemoryImage&) = delete;
+        MemoryImage& operator=(const MemoryImage&) = delete;
+
+        [[nodiscard]]
+        int getHandle() const {
+            return this->handle;
+        }
+
+        [[nodiscard]]
+        size_t getSize() const {
+            return this->size;
+        }
+
+        /* Read only view of the image, backed by the same pages as every copy-on-write mapping of it */
+        [[nodiscard]]
+        std::span<const u8> getContents() const {
+            return { this->contents, this->size };
+        }
+
+    private:
+        int handle = -1;
+        size_t size;
+        const u8 *contents = nullptr;
+    };
+
+    /*
+     * Zero initialized block of memory that stays at the same address for its whole lifetime.
+     * Its contents can be captured into a MemoryImage and replaced by one again, pages of a mapped image only get copied once they're written to
+     */
+    class MappedMemory {
+    public:
+        explicit MappedMemory(size_t size) : size(size) {
+            auto mapping = mmap(nullptr, std::max<size_t>(size, 1), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                throw std::bad_alloc();
+
+            this->memory = static_cast<u8*>(mapping);
+        }
+
+        ~MappedMemory() {
+            munmap(this->memory, std::max<size_t>(this->size, 1));
+        }
+
+        MappedMemory(const MappedMemory&) = delete;
+        MappedMemory& operator=(const MappedMemory&) = delete;
+
+        [[nodiscard]]
+        u8* data() noexcept {
+            return this->memory;
+        }
+
+        [[nodiscard]]
+        const u8* data() const noexcept {
+            return this->memory;
+        }
+
+        [[nodiscard]]
+        size_t getSize() const noexcept {
+            return this->size;
+        }
+
+        [[nodiscard]]
+        std::shared_ptr<const MemoryImage> capture() const {
+            return std::make_shared<const MemoryImage>(std::span(this->memory, this->size));
+        }
+
+        /* Drops the current contents, including all pages copied so far, in favour of the image's. Returns false if the image's size doesn't match */
+        bool map(const MemoryImage &image) {
+            if (image.getSize() != this->size || this->size == 0)
+                return false;
+
+            return mmap(this->memory, this->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, image.getHandle(), 0) != MAP_FAILED;
+        }
+
+    private:
+        u8 *memory;
+        size_t size;
+    };
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+
+namespace vc::util {
+
+    /*
+     * Bounded lock-free single-producer / single-consumer queue.
+     * push() may only ever be called from one thread and pop() / peek() / clear() from one (other) thread.
+     */
+    template<typename T>
+    class RingBuffer {
+    public:
+        explicit RingBuffer(size_t capacity) : capacity(std::bit_ceil(std::max<size_t>(capacity, 2))), mask(this->capacity - 1), storage(new T[this->capacity]) { }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        bool push(const T &value) {
+            const auto tail = this->tail.load(std::memory_order_relaxed);
+
+            if (tail - this->cachedHead == this->capacity) {
+                this->cachedHead = this->head.load(std::memory_order_acquire);
+                if (tail - this->cachedHead == this->capacity)
+                    return false;
+            }
+
+            this->storage[tail & this->mask] = value;
+            this->tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        [[nodiscard]]
+        std::optional<T> pop() {
+            const auto head = this->head.load(std::memory_order_relaxed);
+
+            if (head == this->cachedTail) {
+                this->cachedTail = this->tail.load(std::memory_order_acquire);
+                if (head == this->cachedTail)
+                    return { };
+            }
+
+            T item = std::move(this->storage[head & this->mask]);
+            this->head.store(head + 1, std::memory_order_release);
+
+            return item;
+        }
+
+        [[nodiscard]]
+        const T* peek() {
+            const auto head = this->head.load(std::memory_order_relaxed);
+
+            if (head == this->cachedTail) {
+                this->cachedTail = this->tail.load(std::memory_order_acquire);
+                if (head == this->cachedTail)
+                    return nullptr;
+            }
+
+            return &this->storage[head & this->mask];
+        }
+
+        /* Visits all queued items from oldest to newest. Only safe while neither side is using the buffer */
+        template<typename F>
+        void forEach(F callback) const {
+            const auto tail = this->tail.load(std::memory_order_acquire);
+            for (auto index = this->head.load(std::memory_order_acquire); index != tail; index++)
+                callback(this->storage[index & this->mask]);
+        }
+
+        void clear() {
+            this->cachedTail = this->tail.load(std::memory_order_acquire);
+            this->head.store(this->cachedTail, std::memory_order_release);
+        }
+
+        [[nodiscard]]
+        bool empty() const {
+            return this->head.load(std::memory_order_acquire) == this->tail.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]]
+        size_t size() const {
+            return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]]
+        size_t getCapacity() const {
+            return this->capacity;
+        }
+
+    private:
+        constexpr static inline size_t CacheLineSize = 64;
+
+        const size_t capacity, mask;
+        std::unique_ptr<T[]> storage;
+
+        /* Consumer owned */
+        alignas(CacheLineSize) std::atomic<size_t> head = 0;
+        size_t cachedTail = 0;
+
+        /* Producer owned */
+        alignas(CacheLineSize) std::atomic<size_t> tail = 0;
+        size_t cachedHead = 0;
+    };
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace vc::util {
+
+    class MemoryImage;
+
+    /*
+     * Flat binary image of simulation state, used for in-memory checkpoints.
+     * Values are stored as their raw bytes in the order they got written and have to be read back in that same order.
+     * Contents of memories are only captured for full snapshots and get passed along next to the values, so both kinds of state have the same layout
+     */
+    class StateWriter {
+    public:
+        explicit StateWriter(bool captureMemory = false) : captureMemory(captureMemory) { }
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        void write(const T &value) {
+            const auto bytes = reinterpret_cast<const u8*>(&value);
+            this->data.insert(this->data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void writeBytes(std::span<const u8> bytes) {
+            this->write<u64>(bytes.size());
+            this->data.insert(this->data.end(), bytes.begin(), bytes.end());
+        }
+
+        void writeString(std::string_view string) {
+            this->writeBytes({ reinterpret_cast<const u8*>(string.data()), string.size() });
+        }
+
+        [[nodiscard]]
+        bool capturesMemory() const {
+            return this->captureMemory;
+        }
+
+        void writeImage(std::shared_ptr<const MemoryImage> image) {
+            this->images.push_back(std::move(image));
+        }
+
+        [[nodiscard]]
+        std::vector<u8>& getData() {
+            return this->data;
+        }
+
+        [[nodiscard]]
+        std::vector<std::shared_ptr<const MemoryImage>>& getImages() {
+            return this->images;
+        }
+
+    private:
+        bool captureMemory;
+        std::vector<u8> data;
+        std::vector<std::shared_ptr<const MemoryImage>> images;
+    };
+
+    class StateReader {
+    public:
+        explicit StateReader(std::span<const u8> data, std::span<const std::shared_ptr<const MemoryImage>> images = { }) : data(data), images(images) { }
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        [[nodiscard]]
+        T read() {
+            T value;
+            std::memcpy(&value, this->data.data() + this->position, sizeof(T));
+            this->position += sizeof(T);
+
+            return value;
+        }
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        void read(T &value) {
+            value = this->read<T>();
+        }
+
+        [[nodiscard]]
+        std::span<const u8> readBytes() {
+            const auto size = this->read<u64>();
+            auto bytes = this->data.subspan(this->position, size);
+            this->position += size;
+
+            return bytes;
+        }
+
+        [[nodiscard]]
+        std::string readString() {
+            auto bytes = this->readBytes();
+            return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+        }
+
+        /* Next captured memory image, nothing if the state didn't capture any */
+        [[nodiscard]]
+        std::shared_ptr<const MemoryImage> readImage() {
+            if (this->imagePosition >= this->images.size())
+                return nullptr;
+
+            return this->images[this->imagePosition++];
+        }
+
+    private:
+        std::span<const u8> data;
+        size_t position = 0;
+
+        std::span<const std::shared_ptr<const MemoryImage>> images;
+        size_t imagePosition = 0;
+    };
+
+}
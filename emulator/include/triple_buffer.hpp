@@ -0,0 +1,46 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <array>
+#include <atomic>
+
+namespace vc::util {
+
+    /*
+     * Lock-free single writer / single reader triple buffer.
+     * The writer fills getWriteBuffer() and publishes it as a whole, the reader always gets the most recently published buffer without ever waiting on the writer
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        [[nodiscard]]
+        T& getWriteBuffer() {
+            return this->buffers[this->writeIndex];
+        }
+
+        void publish() {
+            auto previous = this->middle.exchange(this->writeIndex | Fresh, std::memory_order_acq_rel);
+            this->writeIndex = previous & IndexMask;
+        }
+
+        [[nodiscard]]
+        const T& read() {
+            if (this->middle.load(std::memory_order_relaxed) & Fresh) {
+                auto previous = this->middle.exchange(this->readIndex, std::memory_order_acq_rel);
+                this->readIndex = previous & IndexMask;
+            }
+
+            return this->buffers[this->readIndex];
+        }
+
+    private:
+        constexpr static inline u8 Fresh = 0x80;
+        constexpr static inline u8 IndexMask = 0x03;
+
+        std::array<T, 3> buffers = { };
+        u8 writeIndex = 0, readIndex = 1;
+        std::atomic<u8> middle = 2;
+    };
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <imgui.h>
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui_internal.h>
+
+namespace vc::ui {
+
+    /*
+     * Geometry that doesn't change between frames, recorded once relative to the origin and then copied into the frame's draw list at an offset.
+     * Everything recorded has to use the font atlas texture, which is true for all of ImGui's primitive and text functions
+     */
+    class Artwork {
+    public:
+        [[nodiscard]]
+        bool isValid() const {
+            return this->recorded && this->texture == ImGui::GetIO().Fonts->TexID;
+        }
+
+        void invalidate() {
+            this->recorded = false;
+        }
+
+        /* Returns a draw list to record into, sharing the flags of the list the artwork will later be drawn into */
+        [[nodiscard]]
+        ImDrawList& beginRecording(const ImDrawList *target) {
+            this->scratch = std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData());
+            this->scratch->_ResetForNewFrame();
+            this->scratch->Flags = target->Flags;
+            this->scratch->PushClipRectFullScreen();
+            this->scratch->PushTextureID(ImGui::GetIO().Fonts->TexID);
+
+            return *this->scratch;
+        }
+
+        void endRecording() {
+            this->vertices.assign(this->scratch->VtxBuffer.begin(), this->scratch->VtxBuffer.end());
+            this->indices.assign(this->scratch->IdxBuffer.begin(), this->scratch->IdxBuffer.end());
+            this->batches.clear();
+
+            /* Commands only ever get split when the 16 bit index space runs out, group them by their vertex offset */
+            for (const auto &command : this->scratch->CmdBuffer) {
+                if (command.ElemCount == 0) continue;
+
+                if (this->batches.empty() || this->batches.back().vertexOffset != command.VtxOffset)
+                    this->batches.push_back({ command.VtxOffset, 0, command.IdxOffset, 0 });
+
+                this->batches.back().indexCount = command.IdxOffset + command.ElemCount - this->batches.back().indexOffset;
+            }
+
+            for (u32 i = 0; i < this->batches.size(); i++) {
+                auto end = i + 1 < this->batches.size() ? this->batches[i + 1].vertexOffset : u32(this->vertices.size());
+                this->batches[i].vertexCount = end - this->batches[i].vertexOffset;
+            }
+
+            this->scratch.reset();
+            this->texture = ImGui::GetIO().Fonts->TexID;
+            this->recorded = true;
+        }
+
+        void draw(ImDrawList *drawList, ImVec2 offset) const {
+            for (const auto &batch : this->batches) {
+                drawList->PrimReserve(batch.indexCount, batch.vertexCount);
+
+                const auto base = drawList->_VtxCurrentIdx;
+                for (u32 i = 0; i < batch.vertexCount; i++) {
+                    auto vertex = this->vertices[batch.vertexOffset + i];
+                    vertex.pos += offset;
+                    *drawList->_VtxWritePtr++ = vertex;
+                }
+
+                for (u32 i = 0; i < batch.indexCount; i++)
+                    *drawList->_IdxWritePtr++ = ImDrawIdx(base + this->indices[batch.indexOffset + i]);
+
+                drawList->_VtxCurrentIdx += batch.vertexCount;
+            }
+        }
+
+    private:
+        struct Batch {
+            u32 vertexOffset, vertexCount;
+            u32 indexOffset, indexCount;
+        };
+
+        bool recorded = false;
+        ImTextureID texture = nullptr;
+        std::unique_ptr<ImDrawList> scratch;
+
+        std::vector<ImDrawVert> vertices;
+        std::vector<ImDrawIdx> indices;
+        std::vector<Batch> batches;
+    };
+
+}
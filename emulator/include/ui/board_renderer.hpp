@@ -0,0 +1,274 @@
+#pragma once
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <devices/button.hpp>
+#include <devices/led.hpp>
+#include <devices/pin_header.hpp>
+#include <ui/artwork.hpp>
+
+#include <array>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include <imgui.h>
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui_internal.h>
+#include <imgui_vc_extensions.h>
+
+#include <fmt/format.h>
+
+namespace vc::ui {
+
+    /*
+     * Draws a board and the devices on it. The board itself knows nothing about rendering, everything device specific lives in here.
+     * Static artwork gets recorded once, per frame only track activity and the dynamic parts of the devices get drawn
+     */
+    class BoardRenderer {
+    public:
+        explicit BoardRenderer(pcb::Board &board) : board(board) { }
+
+        void draw(ImDrawList *drawList, ImVec2 position) {
+            if (!this->traceArtwork.isValid() || !this->footprintArtwork.isValid())
+                this->recordArtwork(drawList);
+
+            this->traceArtwork.draw(drawList, position);
+
+            const auto &tracks = this->board.getTracks();
+            for (u32 i = 0; i < tracks.size(); i++) {
+                auto changes = tracks[i]->getChangeCount();
+                if (changes == this->trackActivity[i]) continue;
+
+                this->trackActivity[i] = changes;
+
+                const auto &route = this->trackRoutes[i];
+                drawList->AddLine(position + route.start, position + route.middle, ImColor(0x70, 0xF0, 0x90, 0xFF), 3);
+                drawList->AddLine(position + route.middle, position + route.end, ImColor(0x70, 0xF0, 0x90, 0xFF), 3);
+            }
+
+            this->footprintArtwork.draw(drawList, position);
+
+            for (const auto &device : this->devices)
+                this->drawDevice(device, position, drawList);
+        }
+
+        /* Forces the static artwork to be recorded again, e.g. after devices were moved */
+        void invalidate() {
+            this->traceArtwork.invalidate();
+            this->footprintArtwork.invalidate();
+        }
+
+        [[nodiscard]]
+        ImVec2 getSize() const {
+            return toImVec2(this->board.getDimensions());
+        }
+
+    private:
+        [[nodiscard]]
+        static ImVec2 toImVec2(pcb::Vec2 vec) {
+            return { vec.x, vec.y };
+        }
+
+        enum class DeviceKind {
+            CPU,
+            LED,
+            Button,
+            PinHeader,
+            Other
+        };
+
+        struct DeviceEntry {
+            DeviceKind kind;
+            pcb::Connectable *connectable;
+        };
+
+        [[nodiscard]]
+        static DeviceKind getKind(pcb::Connectable &connectable) {
+            if (dynamic_cast<dev::CPUDevice*>(&connectable) != nullptr)
+                return DeviceKind::CPU;
+            else if (dynamic_cast<dev::LED*>(&connectable) != nullptr)
+                return DeviceKind::LED;
+            else if (dynamic_cast<dev::Button*>(&connectable) != nullptr)
+                return DeviceKind::Button;
+            else if (dynamic_cast<dev::PinHeader*>(&connectable) != nullptr)
+                return DeviceKind::PinHeader;
+            else
+                return DeviceKind::Other;
+        }
+
+        /* Device kinds get resolved together with the artwork, so drawing a frame doesn't need to find out what each device is again */
+        void recordArtwork(const ImDrawList *target) {
+            this->devices.clear();
+            for (auto &connectable : this->board.getConnectables()) {
+                connectable->layout();
+                this->devices.push_back({ getKind(*connectable), connectable });
+            }
+
+            auto &traces = this->traceArtwork.beginRecording(target);
+            traces.AddRectFilled(ImVec2(0, 0), this->getSize(), ImColor(0x09, 0x91, 0x32, 0xFF));
+
+            this->trackRoutes.clear();
+            for (auto &track : this->board.getTracks()) {
+                auto [from, to] = track->getEndpoints();
+
+                auto startPos = toImVec2(from->getPosition() + from->getSize() / 2);
+                auto endPos = toImVec2(to->getPosition() + to->getSize() / 2);
+                auto middlePos = startPos.x > startPos.y ? ImVec2(startPos.x, endPos.y) : ImVec2(endPos.x, startPos.y);
+
+                traces.AddLine(startPos, middlePos, ImColor(0x19, 0xC1, 0x62, 0xFF), 3);
+                traces.AddLine(middlePos, endPos, ImColor(0x19, 0xC1, 0x62, 0xFF), 3);
+
+                this->trackRoutes.push_back({ startPos, middlePos, endPos });
+            }
+            this->trackActivity.resize(this->board.getTracks().size(), 0);
+            this->traceArtwork.endRecording();
+
+            auto &footprints = this->footprintArtwork.beginRecording(target);
+            for (const auto &device : this->devices)
+                this->drawFootprint(device, &footprints);
+            this->footprintArtwork.endRecording();
+        }
+
+        /* Everything that never changes, like the footprint. Only gets called when the artwork needs to be recorded again */
+        void drawFootprint(const DeviceEntry &device, ImDrawList *drawList) {
+            auto &connectable = *device.connectable;
+            const auto min = toImVec2(connectable.getPosition());
+            const auto max = min + toImVec2(connectable.getSize());
+
+            switch (device.kind) {
+                case DeviceKind::CPU:
+                    drawList->AddRectFilled(min, max, ImColor(0x10, 0x10, 0x10, 0xFF));
+                    drawList->AddText(min + ImVec2(10, 10), ImColor(0xFFFFFFFF), fmt::format("RISC-V\n {} Core", static_cast<dev::CPUDevice&>(connectable).getCoreCount()).c_str());
+                    break;
+                case DeviceKind::LED:
+                case DeviceKind::Button:
+                    drawList->AddRectFilled(min, max, ImColor(0xA0, 0xA0, 0xA0, 0xFF));
+                    break;
+                case DeviceKind::PinHeader:
+                    drawList->AddRectFilled(min, max, ImColor(0x10, 0x10, 0x10, 0xFF));
+
+                    for (u32 i = 0; i < connectable.getConnectedTracks().size(); i++)
+                        drawList->AddCircleFilled(min + ImVec2(9 + 19 * i, 10), 4, ImColor(0xB0, 0xB0, 0xC0, 0xFF));
+                    break;
+                case DeviceKind::Other:
+                    drawList->AddRectFilled(min, max, ImColor(0x10, 0x10, 0x10, 0xFF));
+                    break;
+            }
+        }
+
+        /* Dynamic parts of the devices, drawn on top of the static artwork every frame */
+        void drawDevice(const DeviceEntry &device, ImVec2 start, ImDrawList *drawList) {
+            auto &connectable = *device.connectable;
+            const auto min = start + toImVec2(connectable.getPosition());
+            const auto max = min + toImVec2(connectable.getSize());
+
+            switch (device.kind) {
+                case DeviceKind::CPU:
+                    this->drawCPU(static_cast<dev::CPUDevice&>(connectable), min, max);
+                    break;
+                case DeviceKind::LED:
+                    drawList->AddRectFilled(min + ImVec2(5, 0), max - ImVec2(5, 0), static_cast<dev::LED&>(connectable).isGlowing() ? ImColor(0xA0, 0x10, 0x10, 0xFF) : ImColor(0x30, 0x10, 0x10, 0xFF));
+                    break;
+                case DeviceKind::Button:
+                    this->drawButton(static_cast<dev::Button&>(connectable), min, max, drawList);
+                    break;
+                case DeviceKind::PinHeader:
+                    this->drawPinHeader(static_cast<dev::PinHeader&>(connectable), min, max);
+                    break;
+                case DeviceKind::Other:
+                    break;
+            }
+        }
+
+        void drawCPU(dev::CPUDevice &cpu, ImVec2 min, ImVec2 max) {
+            if (!ImGui::IsMouseHoveringRect(min, max))
+                return;
+
+            const auto &coreStates = cpu.getCoreStates();
+            bool running = std::any_of(coreStates.begin(), coreStates.end(), [](const auto &state) { return !state.halted; });
+
+            ImGui::BeginTooltip();
+            if (running)
+                ImGui::TextSpinner("Running...");
+            else
+                ImGui::TextUnformatted("Halted");
+
+            ImGui::Separator();
+
+            for (auto &device : cpu.getAddressSpace().getDevices()) {
+                ImGui::TextUnformatted(fmt::format("{}: 0x{:016X} - 0x{:016X}", device->getName(), device->getBase(), device->getEnd()).c_str());
+            }
+
+            ImGui::EndTooltip();
+        }
+
+        void drawButton(dev::Button &button, ImVec2 min, ImVec2 max, ImDrawList *drawList) {
+            auto &displayPressed = this->pressedButtons[&button];
+
+            bool held = ImGui::IsMouseHoveringRect(min, max) && ImGui::IsMouseDown(ImGuiMouseButton_Left);
+            if (held != displayPressed) {
+                displayPressed = held;
+                button.postInput(0, held);
+            }
+
+            drawList->AddCircleFilled((min + max) / 2, 9, displayPressed ? ImColor(0x80, 0x20, 0x20, 0xFF) : ImColor(0xA0, 0x20, 0x20, 0xFF));
+        }
+
+        void drawPinHeader(dev::PinHeader &pinHeader, ImVec2 min, ImVec2 max) {
+            const auto popupId = fmt::format("##pin_header_input_{}", static_cast<void*>(&pinHeader));
+            const bool hovered = ImGui::IsMouseHoveringRect(min, max);
+
+            if (auto inputSlot = pinHeader.getInputSlot(); inputSlot.has_value()) {
+                if (hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+                    ImGui::OpenPopup(popupId.c_str());
+
+                if (ImGui::BeginPopup(popupId.c_str())) {
+                    auto &inputBuffer = this->pinHeaderInputs[&pinHeader];
+
+                    ImGui::TextUnformatted(fmt::format("Send on {}", pinHeader.getConnectedTrackName(*inputSlot)).c_str());
+
+                    if (ImGui::IsWindowAppearing())
+                        ImGui::SetKeyboardFocusHere();
+                    if (ImGui::InputText("##input", inputBuffer.data(), inputBuffer.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+                        for (char c : std::string_view(inputBuffer.data()))
+                            pinHeader.postInput(*inputSlot, u8(c));
+                        pinHeader.postInput(*inputSlot, '\n');
+
+                        inputBuffer.fill(0x00);
+                        ImGui::SetKeyboardFocusHere(-1);
+                    }
+
+                    ImGui::EndPopup();
+                }
+            }
+
+            if (hovered) {
+                const auto &receivedData = pinHeader.getReceivedData();
+
+                ImGui::BeginTooltip();
+                ImGui::TextUnformatted("Connected Tracks");
+                ImGui::Separator();
+                for (u32 slot = 0; slot < receivedData.size(); slot++) {
+                    ImGui::Text("%s: %s", pinHeader.getConnectedTrackName(slot).data(), receivedData[slot].c_str());
+                }
+                ImGui::EndTooltip();
+            }
+        }
+
+        struct TrackRoute {
+            ImVec2 start, middle, end;
+        };
+
+        pcb::Board &board;
+
+        Artwork traceArtwork, footprintArtwork;
+        std::vector<DeviceEntry> devices;
+        std::vector<TrackRoute> trackRoutes;
+        std::vector<u64> trackActivity;
+
+        std::map<const dev::Button*, bool> pressedButtons;
+        std::map<const dev::PinHeader*, std::array<char, 256>> pinHeaderInputs;
+    };
+
+}
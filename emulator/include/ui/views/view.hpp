@@ -18,6 +18,10 @@ namespace vc::ui {
 
         virtual void drawContent() = 0;
 
+        /* Lets the window know that this view has new content to show even though no input happened */
+        [[nodiscard]]
+        virtual bool needsRedraw() { return false; }
+
         virtual void draw() final {
             if (ImGui::Begin(this->viewName.c_str())) {
                 this->drawContent();
@@ -2,8 +2,11 @@
 
 #include <ui/views/view.hpp>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
 #include <future>
 
@@ -41,17 +44,71 @@ namespace vc::ui {
                 }
             }, !this->boardRunning);
 
+            this->drawnRunning = this->boardRunning;
+            this->drawnStateVersion = this->board.getStateVersion();
+
             if (this->boardRunning) {
                 ImGui::TextSpinner("PCB running...");
             } else if (this->boardThread.joinable()) {
                 this->boardThread.join();
             }
+
+            this->drawInputLog();
+        }
+
+        bool needsRedraw() override {
+            return this->boardRunning != this->drawnRunning || (this->drawnRunning && this->board.getStateVersion() != this->drawnStateVersion) || this->board.isReplaying() != this->drawnReplaying;
         }
 
     private:
+        /* Inputs are always recorded from power up on, replays start with the next power up since that's the only point the board's state is known */
+        void drawInputLog() {
+            ImGui::Separator();
+
+            ImGui::InputText("Input log", this->logPath.data(), this->logPath.size());
+
+            if (ImGui::Button("Save recording")) {
+                auto log = this->board.getRecordedInputs();
+                if (!log.isComplete())
+                    this->logStatus = "Inputs older than the time machine's history got dropped, the recording can't be replayed from power up";
+                else if (log.save(this->logPath.data()))
+                    this->logStatus = fmt::format("Saved {} events in {} bytes", log.getEventCount(), log.getSize());
+                else
+                    this->logStatus = "Failed to save input log";
+            }
+
+            ImGui::SameLine();
+            if (ImGui::Button("Replay on power up")) {
+                if (auto log = pcb::InputLog::load(this->logPath.data()); log.has_value()) {
+                    this->logStatus = fmt::format("Replaying {} events on power up", log->getEventCount());
+                    this->board.replayInputs(std::move(*log));
+                } else {
+                    this->logStatus = "Failed to load input log";
+                }
+            }
+
+            ImGui::SameLine();
+            if (ImGui::Button("Stop replay")) {
+                this->board.stopReplay();
+                this->logStatus.clear();
+            }
+
+            this->drawnReplaying = this->board.isReplaying();
+            if (this->drawnReplaying)
+                ImGui::TextSpinner("Replaying inputs...");
+            else if (!this->logStatus.empty())
+                ImGui::TextUnformatted(this->logStatus.c_str());
+        }
+
         pcb::Board &board;
         std::thread boardThread;
-        bool boardRunning = false;
+        std::atomic<bool> boardRunning = false;
+        bool drawnRunning = false;
+        u64 drawnStateVersion = 0;
+
+        bool drawnReplaying = false;
+        std::array<char, 256> logPath = { "inputs.vclog" };
+        std::string logStatus;
     };
 
 }
\ No newline at end of file
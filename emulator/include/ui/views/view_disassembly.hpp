@@ -0,0 +1,326 @@
+#pragma once
+
+#include <ui/views/view.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <devices/cpu/core/disassembler.hpp>
+#include <dirty_bitmap.hpp>
+
+namespace vc::ui {
+
+    /*
+     * Live disassembly of the memory around the harts' program counters.
+     * Pages only get length decoded to find where their instructions start once they're visible or a program counter points into them, until then they're
+     * assumed to be full of uncompressed instructions. The full decode into text happens when a page gets drawn.
+     * Pages get written to invalidate only themselves and, if an instruction crossing into the next page changed length, the page after
+     */
+    class ViewDisassembly : public View {
+    public:
+        explicit ViewDisassembly(pcb::Board &board) : View("Disassembly") {
+            for (auto &device : board.getDevices()) {
+                if (auto cpu = dynamic_cast<dev::CPUDevice*>(device); cpu != nullptr) {
+                    this->cpus.push_back(cpu);
+
+                    for (auto &mmio : cpu->getAddressSpace().getDevices()) {
+                        auto &region = this->regions.emplace_back(mmio);
+                        mmio->addWriteTracker(*region.tracker);
+                    }
+                }
+            }
+
+            std::sort(this->regions.begin(), this->regions.end(), [](const auto &a, const auto &b) { return a.device->getBase() < b.device->getBase(); });
+        }
+
+        ~ViewDisassembly() override {
+            for (auto &region : this->regions)
+                region.device->removeWriteTracker(*region.tracker);
+        }
+
+        void drawContent() override {
+            if (this->regions.empty()) {
+                ImGui::TextUnformatted("No memory mapped");
+                return;
+            }
+
+            const auto programCounters = this->getProgramCounters();
+            this->drawControls(programCounters);
+
+            auto &region = this->regions[this->selectedRegion];
+            this->refresh(region, programCounters);
+
+            const auto rowHeight = ImGui::GetTextLineHeight() + ImGui::GetStyle().CellPadding.y * 2;
+
+            if (ImGui::BeginTable("##disassembly", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 50);
+                ImGui::TableSetupColumn("Address", ImGuiTableColumnFlags_WidthFixed, 130);
+                ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_WidthFixed, 80);
+                ImGui::TableSetupColumn("Instruction");
+                ImGui::TableHeadersRow();
+
+                if (this->followPC && this->selectedHart < programCounters.size()) {
+                    const auto pc = programCounters[this->selectedHart];
+                    if (pc != this->followedPC) {
+                        this->followedPC = pc;
+
+                        if (auto line = this->findLine(region, pc - region.device->getBase()); line.has_value())
+                            ImGui::SetScrollY(std::max(0.0F, *line * rowHeight - ImGui::GetWindowHeight() / 2));
+                    }
+                }
+
+                ImGuiListClipper clipper;
+                clipper.Begin(int(region.lineCount), rowHeight);
+
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                        this->drawLine(region, row, programCounters);
+                }
+
+                ImGui::EndTable();
+            }
+        }
+
+        bool needsRedraw() override {
+            if (this->followPC) {
+                const auto programCounters = this->getProgramCounters();
+                if (this->selectedHart < programCounters.size() && programCounters[this->selectedHart] != this->followedPC)
+                    return true;
+            }
+
+            if (this->regions.empty())
+                return false;
+
+            const auto &region = this->regions[this->selectedRegion];
+            return region.layoutChanged || region.tracker->any();
+        }
+
+    private:
+        constexpr static inline u64 PageSize = 4096;
+
+        struct Page {
+            /* Offsets stay around after the page got written to, so its line count doesn't jump back to the estimate until it got scanned again */
+            bool scanned = false;
+
+            /* Offset of the first instruction, non-zero if an instruction of the previous page extends into this one */
+            u16 start = 0;
+            std::vector<u16> offsets;
+
+            /* Only filled once the page gets shown */
+            std::vector<dev::cpu::DisassembledInstruction> lines;
+        };
+
+        struct Region {
+            explicit Region(dev::cpu::mmio::MMIODevice *device)
+                : device(device), tracker(std::make_unique<util::DirtyBitmap>(device->getSize(), PageSize)), pages(tracker->getPageCount()), firstLine(pages.size(), 0) { }
+
+            dev::cpu::mmio::MMIODevice *device;
+            std::unique_ptr<util::DirtyBitmap> tracker;
+
+            std::vector<Page> pages;
+            std::vector<u64> firstLine;
+            u64 lineCount = 0;
+            bool layoutChanged = true;
+        };
+
+        [[nodiscard]]
+        std::vector<u64> getProgramCounters() {
+            std::vector<u64> result;
+            for (auto &cpu : this->cpus) {
+                for (const auto &state : cpu->getCoreStates())
+                    result.push_back(state.pc);
+            }
+
+            return result;
+        }
+
+        void drawControls(const std::vector<u64> &programCounters) {
+            ImGui::Checkbox("Follow PC", &this->followPC);
+
+            if (programCounters.size() > 1) {
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(100);
+                if (ImGui::BeginCombo("Hart", fmt::format("Hart {}", this->selectedHart).c_str())) {
+                    for (u32 i = 0; i < programCounters.size(); i++) {
+                        if (ImGui::Selectable(fmt::format("Hart {}", i).c_str(), i == this->selectedHart)) {
+                            this->selectedHart = i;
+                            this->followedPC = 0;
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+            }
+
+            if (this->followPC && this->selectedHart < programCounters.size()) {
+                for (u32 i = 0; i < this->regions.size(); i++) {
+                    const auto pc = programCounters[this->selectedHart];
+                    if (pc >= this->regions[i].device->getBase() && pc <= this->regions[i].device->getEnd() && i != this->selectedRegion) {
+                        this->selectedRegion = i;
+                        this->followedPC = 0;
+                    }
+                }
+            }
+
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(250);
+            const auto &current = this->regions[this->selectedRegion].device;
+            if (ImGui::BeginCombo("Region", fmt::format("{} @ 0x{:08X}", current->getName(), current->getBase()).c_str())) {
+                for (u32 i = 0; i < this->regions.size(); i++) {
+                    const auto &device = this->regions[i].device;
+                    if (ImGui::Selectable(fmt::format("{} @ 0x{:08X}", device->getName(), device->getBase()).c_str(), i == this->selectedRegion)) {
+                        this->selectedRegion = i;
+                        this->followPC = false;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        }
+
+        [[nodiscard]]
+        static u16 readParcel(const Region &region, u64 offset) {
+            if (offset + 1 >= region.device->getSize())
+                return 0;
+
+            return region.device->peek(offset) | (region.device->peek(offset + 1) << 8);
+        }
+
+        [[nodiscard]]
+        static u64 getLineCount(const Page &page) {
+            return page.offsets.empty() ? PageSize / dev::cpu::InstructionSize : page.offsets.size();
+        }
+
+        /* Finds where the instructions of a page start, cheap compared to decoding them */
+        static void scanPage(Region &region, u64 index) {
+            auto &page = region.pages[index];
+            const auto previousLineCount = getLineCount(page);
+            const auto pageBase = index * PageSize;
+            const auto pageEnd = std::min<u64>(PageSize, region.device->getSize() - pageBase);
+
+            page.offsets.clear();
+            page.lines.clear();
+
+            u64 offset = page.start;
+            while (offset < pageEnd) {
+                page.offsets.push_back(offset);
+                offset += dev::cpu::getInstructionSize(readParcel(region, pageBase + offset));
+            }
+
+            page.scanned = true;
+            if (getLineCount(page) != previousLineCount)
+                region.layoutChanged = true;
+
+            /* An instruction crossing into the next page determines where that page's instructions start */
+            if (index + 1 < region.pages.size()) {
+                auto &next = region.pages[index + 1];
+                if (next.start != offset - pageEnd) {
+                    next.start = offset - pageEnd;
+                    next.scanned = false;
+                }
+            }
+        }
+
+        /* Rescans the pages the harts are executing in right away so following them lands on the right line, everything else waits until it gets drawn */
+        static void refresh(Region &region, const std::vector<u64> &programCounters) {
+            region.tracker->consume([&](u64 page) {
+                region.pages[page].scanned = false;
+            });
+
+            for (auto pc : programCounters) {
+                if (pc < region.device->getBase() || pc > region.device->getEnd())
+                    continue;
+
+                if (auto index = (pc - region.device->getBase()) / PageSize; !region.pages[index].scanned)
+                    scanPage(region, index);
+            }
+
+            if (region.layoutChanged) {
+                region.lineCount = 0;
+                for (u64 page = 0; page < region.pages.size(); page++) {
+                    region.firstLine[page] = region.lineCount;
+                    region.lineCount += getLineCount(region.pages[page]);
+                }
+
+                region.layoutChanged = false;
+            }
+        }
+
+        [[nodiscard]]
+        static std::optional<u64> findLine(const Region &region, u64 offset) {
+            if (offset >= region.device->getSize())
+                return { };
+
+            const auto index = offset / PageSize;
+            const auto &offsets = region.pages[index].offsets;
+            auto line = std::upper_bound(offsets.begin(), offsets.end(), offset % PageSize);
+            if (line == offsets.begin())
+                return region.firstLine[index];
+
+            return region.firstLine[index] + std::distance(offsets.begin(), line) - 1;
+        }
+
+        void drawLine(Region &region, u64 row, const std::vector<u64> &programCounters) {
+            auto index = u64(std::distance(region.firstLine.begin(), std::upper_bound(region.firstLine.begin(), region.firstLine.end(), row)) - 1);
+            auto &page = region.pages[index];
+
+            if (!page.scanned)
+                scanPage(region, index);
+
+            /* The layout of this frame was made with the estimate, the lines move into place with the next one */
+            const auto line = row - region.firstLine[index];
+            if (line >= page.offsets.size()) {
+                ImGui::TableNextRow();
+                return;
+            }
+
+            if (page.lines.empty()) {
+                page.lines.reserve(page.offsets.size());
+                for (auto offset : page.offsets) {
+                    const auto address = index * PageSize + offset;
+                    const u32 instruction = readParcel(region, address) | (u32(readParcel(region, address + 2)) << 16);
+                    page.lines.push_back(dev::cpu::disassemble(instruction, region.device->getBase() + address));
+                }
+            }
+
+            const auto &instruction = page.lines[line];
+            const auto offset = index * PageSize + page.offsets[line];
+            const auto address = region.device->getBase() + offset;
+
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            for (u32 hart = 0; hart < programCounters.size(); hart++) {
+                if (programCounters[hart] == address) {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+                    ImGui::TextUnformatted(fmt::format(ICON_FA_ARROW_RIGHT " {}", hart).c_str());
+                    break;
+                }
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(fmt::format("0x{:016X}", address).c_str());
+
+            ImGui::TableNextColumn();
+            if (instruction.size == 2)
+                ImGui::TextDisabled("%s", fmt::format("{:04X}", readParcel(region, offset)).c_str());
+            else
+                ImGui::TextDisabled("%s", fmt::format("{:04X}{:04X}", readParcel(region, offset + 2), readParcel(region, offset)).c_str());
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(fmt::format("{:<12} {}", instruction.mnemonic, instruction.operands).c_str());
+        }
+
+        std::vector<dev::CPUDevice*> cpus;
+        std::vector<Region> regions;
+
+        u32 selectedRegion = 0, selectedHart = 0;
+        bool followPC = true;
+        u64 followedPC = 0;
+    };
+
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <ui/views/view.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+#include <dirty_bitmap.hpp>
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui_internal.h>
+
+namespace vc::ui {
+
+    /*
+     * Hex view of everything mapped into a CPU's address space.
+     * Rows are virtualized by hand using a 64 bit row index since the address space can easily contain more rows than ImGui's
+     * float based scrolling can address. Only visible rows are ever read and rows only get read again when their page got written to
+     */
+    class ViewMemory : public View {
+    public:
+        explicit ViewMemory(pcb::Board &board) : View("Memory") {
+            for (auto &device : board.getDevices()) {
+                if (auto cpu = dynamic_cast<dev::CPUDevice*>(device); cpu != nullptr) {
+                    for (auto &mmio : cpu->getAddressSpace().getDevices()) {
+                        auto &region = this->regions.emplace_back(mmio, std::make_unique<util::DirtyBitmap>(mmio->getSize()));
+                        mmio->addWriteTracker(*region.tracker);
+                    }
+                }
+            }
+
+            std::sort(this->regions.begin(), this->regions.end(), [](const auto &a, const auto &b) { return a.device->getBase() < b.device->getBase(); });
+
+            for (auto &region : this->regions) {
+                region.firstRow = this->rowCount;
+                this->rowCount += (region.device->getSize() + BytesPerRow - 1) / BytesPerRow;
+            }
+        }
+
+        ~ViewMemory() override {
+            for (auto &region : this->regions)
+                region.device->removeWriteTracker(*region.tracker);
+        }
+
+        void drawContent() override {
+            if (this->regions.empty()) {
+                ImGui::TextUnformatted("No memory mapped");
+                return;
+            }
+
+            ImGui::SetNextItemWidth(150);
+            if (ImGui::InputScalar("Address", ImGuiDataType_U64, &this->gotoAddress, nullptr, nullptr, "%016llX", ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue))
+                this->scrollTo(this->gotoAddress);
+
+            const auto lineHeight = ImGui::GetTextLineHeightWithSpacing();
+            const auto availableSize = ImGui::GetContentRegionAvail();
+            const auto scrollbarWidth = ImGui::GetStyle().ScrollbarSize;
+
+            const auto visibleRows = std::max<u64>(1, u64(availableSize.y / lineHeight));
+            const auto maxTopRow = this->rowCount > visibleRows ? this->rowCount - visibleRows : 0;
+
+            if (ImGui::BeginChild("##rows", ImVec2(availableSize.x - scrollbarWidth - ImGui::GetStyle().ItemSpacing.x, availableSize.y), false, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse)) {
+                if (ImGui::IsWindowHovered() && ImGui::GetIO().MouseWheel != 0) {
+                    auto delta = i64(ImGui::GetIO().MouseWheel * -3);
+                    this->topRow = delta < 0 ? this->topRow - std::min<u64>(this->topRow, -delta) : this->topRow + delta;
+                }
+
+                this->topRow = std::min(this->topRow, maxTopRow);
+                this->drawRows(std::min(visibleRows, this->rowCount - this->topRow), lineHeight);
+            }
+            ImGui::EndChild();
+
+            /* Slider goes from bottom to top, flip it so the top row is at the top */
+            ImGui::SameLine();
+            u64 inverted = maxTopRow - this->topRow, min = 0;
+            if (ImGui::VSliderScalar("##scroll", ImVec2(scrollbarWidth, availableSize.y), ImGuiDataType_U64, &inverted, &min, &maxTopRow, ""))
+                this->topRow = maxTopRow - inverted;
+        }
+
+        bool needsRedraw() override {
+            if (std::chrono::steady_clock::now() - this->lastChange < HighlightDuration)
+                return true;
+
+            for (const auto &row : this->shownRows) {
+                if (row.region->tracker->isDirty(row.region->tracker->getPage(row.offset)))
+                    return true;
+            }
+
+            return false;
+        }
+
+    private:
+        constexpr static inline u64 BytesPerRow = 16;
+        constexpr static inline auto HighlightDuration = std::chrono::milliseconds(500);
+
+        struct Region {
+            Region(dev::cpu::mmio::MMIODevice *device, std::unique_ptr<util::DirtyBitmap> tracker) : device(device), tracker(std::move(tracker)) { }
+
+            dev::cpu::mmio::MMIODevice *device;
+            std::unique_ptr<util::DirtyBitmap> tracker;
+            u64 firstRow = 0;
+        };
+
+        struct Row {
+            Region *region;
+            u64 offset;
+            std::array<u8, BytesPerRow> bytes;
+            std::array<std::chrono::steady_clock::time_point, BytesPerRow> changed;
+        };
+
+        [[nodiscard]]
+        Region& findRegion(u64 row) {
+            auto region = std::upper_bound(this->regions.begin(), this->regions.end(), row, [](u64 row, const auto &region) { return row < region.firstRow; });
+            return *std::prev(region);
+        }
+
+        void scrollTo(u64 address) {
+            for (auto &region : this->regions) {
+                if (address < region.device->getBase() || address > region.device->getEnd()) continue;
+
+                this->topRow = region.firstRow + (address - region.device->getBase()) / BytesPerRow;
+                return;
+            }
+        }
+
+        static void readRow(Row &row) {
+            const auto size = std::min(BytesPerRow, row.region->device->getSize() - row.offset);
+            for (u64 i = 0; i < size; i++)
+                row.bytes[i] = row.region->device->peek(row.offset + i);
+        }
+
+        /* Re-reads rows in pages that got written to and keeps everything else from the previous frame */
+        void updateRows(u64 visibleRows) {
+            const auto now = std::chrono::steady_clock::now();
+
+            if (this->shownTopRow != this->topRow || this->shownRows.size() != visibleRows) {
+                this->shownRows.resize(visibleRows);
+
+                for (u64 i = 0; i < visibleRows; i++) {
+                    auto &region = this->findRegion(this->topRow + i);
+                    auto &row = this->shownRows[i];
+
+                    row.region = &region;
+                    row.offset = (this->topRow + i - region.firstRow) * BytesPerRow;
+                    row.changed.fill({ });
+                    region.tracker->testAndClear(region.tracker->getPage(row.offset));
+                    readRow(row);
+                }
+
+                this->shownTopRow = this->topRow;
+                return;
+            }
+
+            const Region *lastRegion = nullptr;
+            u64 lastPage = 0;
+            bool lastDirty = false;
+
+            for (auto &row : this->shownRows) {
+                const auto page = row.region->tracker->getPage(row.offset);
+                if (row.region != lastRegion || page != lastPage) {
+                    lastRegion = row.region;
+                    lastPage = page;
+                    lastDirty = row.region->tracker->testAndClear(page);
+                }
+
+                if (!lastDirty) continue;
+
+                auto previous = row.bytes;
+                readRow(row);
+
+                for (u64 i = 0; i < BytesPerRow; i++) {
+                    if (row.bytes[i] != previous[i]) {
+                        row.changed[i] = now;
+                        this->lastChange = now;
+                    }
+                }
+            }
+        }
+
+        void drawRows(u64 visibleRows, float lineHeight) {
+            this->updateRows(visibleRows);
+
+            auto drawList = ImGui::GetWindowDrawList();
+            const auto start = ImGui::GetCursorScreenPos();
+            const auto charWidth = ImGui::CalcTextSize("0").x;
+            const auto hexStart = charWidth * 18;
+            const auto asciiStart = hexStart + charWidth * (BytesPerRow * 3 + 1);
+            const auto now = std::chrono::steady_clock::now();
+
+            const auto textColor = ImGui::GetColorU32(ImGuiCol_Text);
+            const auto dimColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+
+            for (u64 i = 0; i < this->shownRows.size(); i++) {
+                const auto &row = this->shownRows[i];
+                const auto rowPos = start + ImVec2(0, i * lineHeight);
+                const auto size = std::min(BytesPerRow, row.region->device->getSize() - row.offset);
+
+                if (i > 0 && row.offset == 0)
+                    drawList->AddLine(rowPos, rowPos + ImVec2(asciiStart + charWidth * BytesPerRow, 0), dimColor);
+
+                drawList->AddText(rowPos, dimColor, fmt::format("{:016X}", row.region->device->getBase() + row.offset).c_str());
+
+                std::string hex, ascii;
+                for (u64 byte = 0; byte < size; byte++) {
+                    const auto value = row.bytes[byte];
+                    hex += fmt::format("{:02X} ", value);
+                    ascii += std::isprint(value) ? char(value) : '.';
+
+                    auto age = std::chrono::duration<float>(now - row.changed[byte]) / HighlightDuration;
+                    if (age < 1.0F) {
+                        const auto bytePos = rowPos + ImVec2(hexStart + byte * charWidth * 3, 0);
+                        drawList->AddRectFilled(bytePos, bytePos + ImVec2(charWidth * 2, lineHeight), ImColor(0.9F, 0.3F, 0.2F, 1.0F - age));
+                    }
+                }
+
+                drawList->AddText(rowPos + ImVec2(hexStart, 0), textColor, hex.c_str());
+                drawList->AddText(rowPos + ImVec2(asciiStart, 0), textColor, ascii.c_str());
+
+                if (i == 0 || row.offset == 0)
+                    drawList->AddText(rowPos + ImVec2(asciiStart + charWidth * (BytesPerRow + 2), 0), dimColor, row.region->device->getName().data());
+            }
+
+            ImGui::Dummy(ImVec2(asciiStart + charWidth * BytesPerRow, this->shownRows.size() * lineHeight));
+        }
+
+        std::vector<Region> regions;
+        u64 rowCount = 0;
+
+        u64 topRow = 0, gotoAddress = 0;
+        u64 shownTopRow = 0;
+        std::vector<Row> shownRows;
+        std::chrono::steady_clock::time_point lastChange;
+    };
+
+}
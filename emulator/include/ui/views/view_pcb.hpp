@@ -7,6 +7,7 @@
 #include <thread>
 
 #include <board/board_test.hpp>
+#include <ui/board_renderer.hpp>
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
@@ -15,19 +16,26 @@ namespace vc::ui {
 
     class ViewPCB : public View {
     public:
-       explicit ViewPCB(pcb::Board &board) : View("PCB"), board(board) { }
+       explicit ViewPCB(pcb::Board &board) : View("PCB"), board(board), renderer(board) { }
 
         void drawContent() override {
             auto drawList = ImGui::GetWindowDrawList();
             auto windowPos = ImGui::GetWindowPos();
             auto windowSize = ImGui::GetWindowSize();
 
-            board.setPosition(windowPos + (windowSize - board.getDimensions()) / 2);
-            board.draw(drawList);
+            this->drawnStateVersion = board.getStateVersion();
+
+            this->renderer.draw(drawList, windowPos + (windowSize - this->renderer.getSize()) / 2);
+        }
+
+        bool needsRedraw() override {
+            return this->board.getStateVersion() != this->drawnStateVersion;
         }
 
     private:
         pcb::Board &board;
+        BoardRenderer renderer;
+        u64 drawnStateVersion = 0;
         std::string console = "Console: ";
     };
 
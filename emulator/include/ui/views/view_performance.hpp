@@ -0,0 +1,157 @@
+#pragma once
+
+#include <ui/views/view.hpp>
+#include <ui/window.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <board/board.hpp>
+#include <devices/cpu/cpu.hpp>
+
+#include <implot.h>
+
+namespace vc::ui {
+
+    /* Rolling graphs of how fast the board is being simulated. All values are sampled from counters the simulation keeps anyways */
+    class ViewPerformance : public View {
+    public:
+        ViewPerformance(pcb::Board &board, Window &window) : View("Performance"), board(board), window(window) { }
+
+        void drawContent() override {
+            auto now = std::chrono::steady_clock::now();
+            if (now - this->lastSample >= SampleInterval)
+                this->sample(now);
+
+            ImGui::TextUnformatted(fmt::format("Virtual time: {} ticks ({:.2f}x real time)", this->board.getVirtualTime(), this->simulationRatio.latest()).c_str());
+            ImGui::TextUnformatted(fmt::format("Frame time: {:.2f} ms", this->frameTime.latest()).c_str());
+
+            ImGui::Separator();
+
+            float maxRate = 0;
+            for (const auto &hart : this->harts)
+                maxRate = std::max(maxRate, hart.history.max());
+
+            this->setupLimits(maxRate);
+            if (ImPlot::BeginPlot("Instructions / s", nullptr, nullptr, ImVec2(-1, PlotHeight), ImPlotFlags_NoMousePos)) {
+                for (u32 i = 0; i < this->harts.size(); i++)
+                    this->plot(fmt::format("Hart {}", i).c_str(), this->harts[i].history);
+
+                ImPlot::EndPlot();
+            }
+
+            this->drawGraph("Device ticks / s", this->deviceTicks);
+            this->drawGraph("Track transfers / s", this->trackTransfers);
+            this->drawGraph("Frame time (ms)", this->frameTime);
+            this->drawGraph("Simulation / wall time", this->simulationRatio);
+        }
+
+        bool needsRedraw() override {
+            if (std::chrono::steady_clock::now() - this->lastSample < SampleInterval)
+                return false;
+
+            /* Keep sampling while the board runs and once more after it stopped so the graphs drop back to zero */
+            return this->board.getVirtualTime() != this->sampledVirtualTime || !this->settled;
+        }
+
+    private:
+        constexpr static inline auto SampleInterval = std::chrono::milliseconds(100);
+        constexpr static inline size_t HistorySize = 100;
+        constexpr static inline float PlotHeight = 120.0F;
+
+        class History {
+        public:
+            void push(float value) {
+                this->values[this->offset] = value;
+                this->offset = (this->offset + 1) % HistorySize;
+                this->count = std::min(this->count + 1, HistorySize);
+            }
+
+            [[nodiscard]]
+            float latest() const {
+                return this->count == 0 ? 0.0F : this->values[(this->offset + HistorySize - 1) % HistorySize];
+            }
+
+            [[nodiscard]]
+            float max() const {
+                return this->count == 0 ? 0.0F : *std::max_element(this->values.begin(), this->values.begin() + this->count);
+            }
+
+            std::array<float, HistorySize> values = { };
+            size_t offset = 0, count = 0;
+        };
+
+        struct Hart {
+            dev::CPUDevice *cpu;
+            u32 core;
+            u64 retired;
+            History history;
+        };
+
+        /* Counters may go back to zero when the board gets powered up again */
+        static u64 delta(u64 current, u64 &previous) {
+            auto result = current >= previous ? current - previous : current;
+            previous = current;
+
+            return result;
+        }
+
+        void sample(std::chrono::steady_clock::time_point now) {
+            const auto seconds = std::chrono::duration<float>(now - this->lastSample).count();
+            this->lastSample = now;
+
+            if (this->harts.empty()) {
+                for (auto &device : this->board.getDevices()) {
+                    if (auto cpu = dynamic_cast<dev::CPUDevice*>(device); cpu != nullptr) {
+                        for (u32 core = 0; core < cpu->getCoreCount(); core++)
+                            this->harts.push_back({ cpu, core, cpu->getRetiredInstructions(core), { } });
+                    }
+                }
+            }
+
+            for (auto &hart : this->harts)
+                hart.history.push(delta(hart.cpu->getRetiredInstructions(hart.core), hart.retired) / seconds);
+
+            const auto virtualTime = this->board.getVirtualTime();
+            const auto previousVirtualTime = this->sampledVirtualTime;
+            const auto virtualSeconds = float(delta(virtualTime, this->sampledVirtualTime)) / this->board.getTickFrequency();
+
+            this->deviceTicks.push(delta(this->board.getDeviceTicks(), this->sampledDeviceTicks) / seconds);
+            this->trackTransfers.push(delta(this->board.getTrackTraffic(), this->sampledTrackTransfers) / seconds);
+            this->frameTime.push(this->window.getFrameDuration() * 1000);
+            this->simulationRatio.push(virtualSeconds / seconds);
+
+            this->settled = virtualTime == previousVirtualTime;
+        }
+
+        void plot(const char *label, const History &history) {
+            ImPlot::PlotLine(label, history.values.data(), history.count, 1.0, 0.0, history.count < HistorySize ? 0 : history.offset);
+        }
+
+        static void setupLimits(float maxValue) {
+            ImPlot::SetNextPlotLimits(0, HistorySize, 0, std::max(maxValue * 1.1F, 1.0F), ImGuiCond_Always);
+        }
+
+        void drawGraph(const char *title, const History &history) {
+            this->setupLimits(history.max());
+            if (ImPlot::BeginPlot(title, nullptr, nullptr, ImVec2(-1, PlotHeight), ImPlotFlags_NoLegend | ImPlotFlags_NoMousePos)) {
+                this->plot(title, history);
+                ImPlot::EndPlot();
+            }
+        }
+
+        pcb::Board &board;
+        Window &window;
+
+        std::chrono::steady_clock::time_point lastSample = std::chrono::steady_clock::now();
+        u64 sampledVirtualTime = 0, sampledDeviceTicks = 0, sampledTrackTransfers = 0;
+        bool settled = true;
+
+        std::vector<Hart> harts;
+        History deviceTicks, trackTransfers, frameTime, simulationRatio;
+    };
+
+}
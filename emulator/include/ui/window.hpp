@@ -17,6 +17,22 @@ namespace vc::ui {
 
         void loop();
 
+        /* Upper limit for the frame rate. Frames only get rendered when input arrived or a view has something new to show */
+        void setTargetFps(double fps) {
+            this->targetFps = fps;
+        }
+
+        /* Time in seconds it took to build and render the last frame, not counting the time spent waiting for the next one */
+        [[nodiscard]]
+        double getFrameDuration() const {
+            return this->frameDuration;
+        }
+
+        /* Requests a few frames to be rendered so ImGui can settle hover states and animations */
+        void markDirty() {
+            this->pendingFrames = SettleFrames;
+        }
+
         template<typename T, typename ... Args>
         auto& addView(Args&&... args) {
             auto view = new T(std::forward<Args>(args)...);
@@ -26,6 +42,11 @@ namespace vc::ui {
         }
 
     private:
+        constexpr static inline u32 SettleFrames = 3;
+
+        [[nodiscard]]
+        bool viewsNeedRedraw() const;
+
         void frameBegin();
         void frame();
         void frameEnd();
@@ -39,6 +60,8 @@ namespace vc::ui {
 
         double targetFps = 60.0;
         double lastFrameTime = 0.0;
+        double frameStartTime = 0.0, frameDuration = 0.0;
+        u32 pendingFrames = SettleFrames;
 
         std::vector<View*> views;
     };
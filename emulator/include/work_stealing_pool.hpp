@@ -0,0 +1,155 @@
+#pragma once
+
+#include <risc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace vc::util {
+
+    /*
+     * Fixed set of threads working through coarse grained tasks.
+     * Every worker has a queue of its own that it works through in order and only ever touches the other queues to steal from their back once its own ran dry.
+     * Tasks are expected to run for a while each, the queues are therefore simply guarded by a mutex and workers without anything to do go to sleep
+     */
+    template<typename Task>
+    class WorkStealingPool {
+    public:
+        explicit WorkStealingPool(u32 workerCount = 0) {
+            this->setWorkerCount(workerCount);
+        }
+
+        /* Zero sizes the pool to the host */
+        void setWorkerCount(u32 count) {
+            this->workerCount = count != 0 ? count : std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        [[nodiscard]]
+        u32 getWorkerCount() const {
+            return this->workerCount;
+        }
+
+        /* Number of tasks a worker took from another worker's queue during the last run */
+        [[nodiscard]]
+        u64 getStealCount() const {
+            return this->stealCount.load(std::memory_order_relaxed);
+        }
+
+        /*
+         * Runs all tasks and returns once none are left. The handler gets a task and the index of the worker running it and returns what that worker queues next:
+         * the task itself to continue it later, another task to take its place or nothing once it's done
+         */
+        void run(std::vector<Task> tasks, const std::function<std::optional<Task>(Task task, u32 worker)> &handler) {
+            this->stealCount = 0;
+            if (tasks.empty())
+                return;
+
+            /* More workers than tasks would never get anything to do */
+            const auto threadCount = u32(std::min<size_t>(this->workerCount, tasks.size()));
+
+            std::vector<Queue> queues(threadCount);
+            for (size_t i = 0; i < tasks.size(); i++)
+                queues[i % queues.size()].tasks.push_back(std::move(tasks[i]));
+
+            std::atomic<size_t> pending = tasks.size();
+
+            /*
+             * Bumped whenever a queue holds a task its owner isn't about to take itself and once everything is done.
+             * Idle workers sleep on it instead of spinning, reading it before looking for work means no bump can get lost in between
+             */
+            std::atomic<u32> workAvailable = 0;
+            auto signal = [&](bool everyone) {
+                workAvailable.fetch_add(1, std::memory_order_release);
+                if (everyone)
+                    workAvailable.notify_all();
+                else
+                    workAvailable.notify_one();
+            };
+
+            auto worker = [&, this](u32 id) {
+                while (pending.load(std::memory_order_acquire) > 0) {
+                    const auto seen = workAvailable.load(std::memory_order_acquire);
+
+                    auto task = queues[id].popFront();
+                    if (!task.has_value())
+                        task = this->steal(queues, id);
+
+                    if (!task.has_value()) {
+                        workAvailable.wait(seen, std::memory_order_acquire);
+                        continue;
+                    }
+
+                    if (auto next = handler(std::move(*task), id); next.has_value()) {
+                        if (queues[id].pushBack(std::move(*next)) > 1)
+                            signal(false);
+                    } else if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        signal(true);
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (u32 id = 1; id < threadCount; id++)
+                threads.emplace_back(worker, id);
+
+            worker(0);
+
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+
+            std::optional<Task> popFront() {
+                std::scoped_lock lock(this->mutex);
+                if (this->tasks.empty())
+                    return { };
+
+                auto task = std::move(this->tasks.front());
+                this->tasks.pop_front();
+                return task;
+            }
+
+            std::optional<Task> popBack() {
+                std::scoped_lock lock(this->mutex);
+                if (this->tasks.empty())
+                    return { };
+
+                auto task = std::move(this->tasks.back());
+                this->tasks.pop_back();
+                return task;
+            }
+
+            /* Returns the number of tasks queued afterwards */
+            size_t pushBack(Task task) {
+                std::scoped_lock lock(this->mutex);
+                this->tasks.push_back(std::move(task));
+                return this->tasks.size();
+            }
+        };
+
+        std::optional<Task> steal(std::vector<Queue> &queues, u32 thief) {
+            for (u32 offset = 1; offset < queues.size(); offset++) {
+                if (auto task = queues[(thief + offset) % queues.size()].popBack(); task.has_value()) {
+                    this->stealCount.fetch_add(1, std::memory_order_relaxed);
+                    return task;
+                }
+            }
+
+            return { };
+        }
+
+        u32 workerCount = 1;
+        std::atomic<u64> stealCount = 0;
+    };
+
+}
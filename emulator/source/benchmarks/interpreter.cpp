@@ -0,0 +1,293 @@
+#include <board/board_headless.hpp>
+#include <board/runner.hpp>
+#include <devices/cpu/core/assembler.hpp>
+#include <benchmark.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using vc::dev::cpu::Assembler;
+
+    constexpr int ExitUsage     = 2;
+    constexpr int ExitFailed    = 1;
+
+    constexpr u64 FlashBase     = 0x0000'0000;
+    constexpr u64 RamBase       = 0x1000'0000;
+    constexpr u64 UartBase      = 0x5000'0000;
+
+    /* Every workload is an endless loop, runs get bounded by the number of instructions alone */
+    struct Workload {
+        std::string_view name;
+        std::string_view description;
+        std::function<void(Assembler&)> build;
+    };
+
+    /* Dependent immediate operations, nothing but decode and register file */
+    void buildAluChain(Assembler &a) {
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        for (u32 i = 0; i < 8; i++) {
+            a.addi(5, 5, 1);
+            a.xori(6, 5, 0x55);
+            a.ori(7, 6, 0x100);
+            a.andi(8, 7, 0x7FF);
+            a.addiw(5, 8, -3);
+        }
+
+        a.jal(0, loop);
+    }
+
+    /* Loads and stores of every width spread over two KiB of RAM */
+    void buildLoadStore(Assembler &a) {
+        a.li(10, RamBase);
+
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        a.addi(11, 11, 1);
+        for (i32 offset = 0; offset < 2048 - 32; offset += 128) {
+            a.sd(11, 10, offset);
+            a.ld(12, 10, offset);
+            a.sw(12, 10, offset + 8);
+            a.lb(13, 10, offset + 8);
+            a.sh(13, 10, offset + 16);
+            a.lbu(14, 10, offset + 16);
+            a.sb(14, 10, offset + 24);
+        }
+
+        a.jal(0, loop);
+    }
+
+    /* Forward branches on the bits of a counter, taken with every period from two to 256 iterations */
+    void buildBranchy(Assembler &a) {
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        a.addi(5, 5, 1);
+        for (u32 bit = 0; bit < 8; bit++) {
+            auto skip = a.createLabel();
+
+            a.andi(6, 5, 1 << bit);
+            if (bit % 2 == 0)
+                a.beq(6, 0, skip);
+            else
+                a.bne(6, 0, skip);
+            a.addi(7, 7, 1);
+            a.bind(skip);
+        }
+
+        a.jal(0, loop);
+    }
+
+    /* Nothing but 16 bit instructions inside the loop, including its jump back */
+    void buildCompressed(Assembler &a) {
+        a.li(2, RamBase);
+        a.addi(9, 0, i32(a.getAddress() + vc::dev::cpu::InstructionSize));
+
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        for (u32 i = 0; i < 8; i++) {
+            a.c_li(10, 5);
+            a.c_addi(10, 3);
+            a.c_addiw(11, -1);
+            a.c_sdsp(10, i * 8);
+            a.c_ldsp(12, i * 8);
+        }
+
+        a.c_jr(9);
+    }
+
+    /* Register accesses to the UART, every transmitted byte travels over the board's track to the console */
+    void buildMmio(Assembler &a) {
+        a.li(10, UartBase);
+
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        for (u32 i = 0; i < 8; i++) {
+            a.addi(11, 11, 1);
+            a.sb(11, 10, 4);
+            a.lb(12, 10, 8);
+            a.sw(12, 10, 0);
+        }
+
+        a.jal(0, loop);
+    }
+
+    const std::vector<Workload> Workloads = {
+        { "alu_chain",  "Dependent ALU immediates",         buildAluChain },
+        { "load_store", "Loads and stores of all widths",   buildLoadStore },
+        { "branchy",    "Data dependent forward branches",  buildBranchy },
+        { "compressed", "Compressed instructions only",     buildCompressed },
+        { "mmio",       "UART register accesses",           buildMmio },
+    };
+
+    struct Options {
+        u64 instructions = 10'000'000;
+        u32 repetitions = 3;
+        std::optional<std::string_view> filter, jsonPath;
+    };
+
+    struct Result {
+        std::string_view name;
+        u64 instructions;
+        double bestSeconds, medianSeconds;
+        u64 allocations, allocatedBytes;
+
+        [[nodiscard]]
+        double getMIPS() const {
+            return this->instructions / this->bestSeconds / 1'000'000;
+        }
+
+        [[nodiscard]]
+        double getNanosecondsPerInstruction() const {
+            return this->bestSeconds * 1'000'000'000 / this->instructions;
+        }
+    };
+
+    void printUsage(const char *name) {
+        fmt::print(stderr,
+            "Usage: {} [options]\n"
+            "  --instructions <n>     Instructions to retire per repetition\n"
+            "  --repeat <n>           Timed repetitions of every workload, the fastest one gets reported\n"
+            "  --filter <text>        Only run workloads whose name contains the text\n"
+            "  --json <path>          Write the results as JSON, - for stdout\n"
+            "  --list                 List all workloads\n",
+            name);
+    }
+
+    [[nodiscard]]
+    std::optional<Result> runWorkload(const Workload &workload, const Options &options) {
+        vc::pcb::HeadlessBoard board;
+        board.setWorkerCount(1);
+
+        Assembler assembler(FlashBase);
+        workload.build(assembler);
+        board.cpu.getAddressSpace().loadBinary(FlashBase, assembler.getCode());
+
+        vc::pcb::Runner runner(board);
+        runner.setConsoleOutput(nullptr);
+        runner.setCaptureOutput(false);
+
+        /* Warms up caches and gets the board started, which allocates */
+        const auto warmup = runner.run(std::max<u64>(options.instructions / 10, 1));
+        if (warmup.reason != vc::pcb::StopReason::InstructionLimit) {
+            vc::log::error("Workload '{}' stopped after {} instructions instead of running on", workload.name, warmup.instructions);
+            return { };
+        }
+
+        std::vector<double> seconds;
+        seconds.reserve(options.repetitions);
+
+        const auto startAllocations = vc::bench::getAllocationCount(), startBytes = vc::bench::getAllocatedBytes();
+
+        for (u32 i = 0; i < options.repetitions; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto run = runner.run(options.instructions);
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            if (run.reason != vc::pcb::StopReason::InstructionLimit || run.instructions != options.instructions) {
+                vc::log::error("Workload '{}' retired {} instead of {} instructions", workload.name, run.instructions, options.instructions);
+                return { };
+            }
+        }
+
+        const auto allocations = vc::bench::getAllocationCount() - startAllocations, bytes = vc::bench::getAllocatedBytes() - startBytes;
+
+        std::sort(seconds.begin(), seconds.end());
+        return Result {
+            .name = workload.name,
+            .instructions = options.instructions,
+            .bestSeconds = seconds.front(),
+            .medianSeconds = seconds[seconds.size() / 2],
+            .allocations = allocations / options.repetitions,
+            .allocatedBytes = bytes / options.repetitions
+        };
+    }
+
+    bool writeJson(const std::vector<Result> &results, const Options &options) {
+        FILE *file = stdout;
+        if (*options.jsonPath != "-") {
+            file = fopen(std::string(*options.jsonPath).c_str(), "wb");
+            if (file == nullptr) {
+                vc::log::error("Failed to open '{}' for writing", *options.jsonPath);
+                return false;
+            }
+        }
+
+        fmt::print(file, "{{\n  \"benchmark\": \"interpreter\",\n  \"instructions\": {},\n  \"repetitions\": {},\n  \"workloads\": [\n", options.instructions, options.repetitions);
+        for (u32 i = 0; i < results.size(); i++) {
+            const auto &result = results[i];
+
+            fmt::print(file, "    {{ \"name\": \"{}\", \"mips\": {:.3f}, \"ns_per_instruction\": {:.3f}, \"best_seconds\": {:.6f}, \"median_seconds\": {:.6f}, \"allocations\": {}, \"allocated_bytes\": {} }}{}\n",
+                result.name, result.getMIPS(), result.getNanosecondsPerInstruction(), result.bestSeconds, result.medianSeconds,
+                result.allocations, result.allocatedBytes, i + 1 < results.size() ? "," : "");
+        }
+        fmt::print(file, "  ]\n}}\n");
+
+        if (file != stdout)
+            fclose(file);
+
+        return true;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--instructions" && hasValue)
+                options.instructions = std::max(1ULL, std::stoull(argv[++i], nullptr, 0));
+            else if (argument == "--repeat" && hasValue)
+                options.repetitions = std::max(1UL, std::stoul(argv[++i]));
+            else if (argument == "--filter" && hasValue)
+                options.filter = argv[++i];
+            else if (argument == "--json" && hasValue)
+                options.jsonPath = argv[++i];
+            else if (argument == "--list") {
+                for (const auto &workload : Workloads)
+                    fmt::print("{:<12} {}\n", workload.name, workload.description);
+                return 0;
+            } else {
+                printUsage(argv[0]);
+                return ExitUsage;
+            }
+        } catch (const std::logic_error&) {
+            printUsage(argv[0]);
+            return ExitUsage;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const auto &workload : Workloads) {
+        if (options.filter.has_value() && workload.name.find(*options.filter) == std::string_view::npos)
+            continue;
+
+        auto result = runWorkload(workload, options);
+        if (!result.has_value())
+            return ExitFailed;
+
+        vc::log::info("{:<12} {:8.2f} MIPS {:8.2f} ns/instruction {:6} allocations per run", result->name, result->getMIPS(), result->getNanosecondsPerInstruction(), result->allocations);
+        results.push_back(*result);
+    }
+
+    if (options.jsonPath.has_value() && !writeJson(results, options))
+        return ExitUsage;
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+#include <board/board_synthetic.hpp>
+#include <board/fleet.hpp>
+#include <board/runner.hpp>
+#include <devices/cpu/core/assembler.hpp>
+#include <benchmark.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using vc::pcb::SyntheticBoard;
+    using vc::pcb::SyntheticBoardConfig;
+
+    constexpr int ExitUsage     = 2;
+    constexpr int ExitFailed    = 1;
+
+    struct Options {
+        u32 maxSize = 1024;
+        double minSeconds = 0.5;
+        u32 fleetBoards = 64;
+        u64 boardInstructions = 200'000;
+        u32 maxThreads = std::max(1U, std::thread::hardware_concurrency());
+        std::optional<std::string_view> filter, jsonPath;
+    };
+
+    /* One board size along one of the swept dimensions */
+    struct Point {
+        u32 value;
+        double startupSeconds;
+        u64 instructions;
+        double steadySeconds;
+        u64 deviceTicks;
+        u64 heapBytes, residentBytes;
+        u64 allocations;
+
+        [[nodiscard]]
+        double getNanosecondsPerInstruction() const {
+            return this->steadySeconds * 1'000'000'000 / this->instructions;
+        }
+
+        [[nodiscard]]
+        double getTicksPerInstruction() const {
+            return double(this->deviceTicks) / this->instructions;
+        }
+    };
+
+    struct Sweep {
+        std::string_view dimension;
+        std::vector<Point> points;
+    };
+
+    struct ThreadPoint {
+        u32 workers;
+        double seconds;
+        u64 instructions;
+        u64 steals;
+
+        [[nodiscard]]
+        double getMIPS() const {
+            return this->instructions / this->seconds / 1'000'000;
+        }
+    };
+
+    /* Endless loop through RAM and the first and last GPIO block, so every access searches the bus */
+    void buildFirmware(vc::dev::cpu::Assembler &a, u32 peripherals) {
+        a.li(10, SyntheticBoard::RamBase);
+        if (peripherals > 0) {
+            a.li(11, SyntheticBoard::PeripheralBase);
+            a.li(12, SyntheticBoard::PeripheralBase + (peripherals - 1) * SyntheticBoard::PeripheralStride);
+        }
+
+        auto loop = a.createLabel();
+        a.bind(loop);
+
+        for (u32 i = 0; i < 4; i++) {
+            a.addi(5, 5, 1);
+            a.sd(5, 10, i * 8);
+            a.ld(6, 10, i * 8);
+
+            if (peripherals > 0) {
+                a.sw(5, 11, 8);
+                a.lb(7, 12, 4);
+            }
+        }
+
+        a.jal(0, loop);
+    }
+
+    [[nodiscard]]
+    std::unique_ptr<SyntheticBoard> createBoard(SyntheticBoardConfig config) {
+        auto board = std::make_unique<SyntheticBoard>(config);
+
+        vc::dev::cpu::Assembler assembler(SyntheticBoard::FlashBase);
+        buildFirmware(assembler, config.peripherals);
+        board->cpu.getAddressSpace().loadBinary(SyntheticBoard::FlashBase, assembler.getCode());
+
+        return board;
+    }
+
+    [[nodiscard]]
+    std::optional<Point> measure(SyntheticBoardConfig config, u32 value, const Options &options) {
+        Point point = { .value = value };
+
+        const auto startHeap = vc::bench::getHeapUsage();
+        const auto startResident = vc::bench::getResidentMemory();
+
+        /* Everything up to the first instruction, like powering up a freshly created board does */
+        const auto startupStart = std::chrono::steady_clock::now();
+        auto board = createBoard(config);
+        board->setWorkerCount(1);
+        board->reset();
+        point.startupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startupStart).count();
+
+        vc::pcb::Runner runner(*board);
+        if (runner.run(1'000).reason != vc::pcb::StopReason::InstructionLimit) {
+            vc::log::error("Synthetic board stopped during warmup");
+            return { };
+        }
+
+        point.heapBytes = vc::bench::getHeapUsage() - std::min(startHeap, vc::bench::getHeapUsage());
+        point.residentBytes = vc::bench::getResidentMemory() - std::min(startResident, vc::bench::getResidentMemory());
+
+        /* Doubles the batch size until the minimum time is reached, which keeps small boards from being dominated by per run overhead */
+        const auto startAllocations = vc::bench::getAllocationCount();
+        const auto startTicks = board->getDeviceTicks();
+        const auto steadyStart = std::chrono::steady_clock::now();
+
+        for (u64 batch = 10'000; point.steadySeconds < options.minSeconds; batch *= 2) {
+            const auto run = runner.run(batch);
+            if (run.reason != vc::pcb::StopReason::InstructionLimit) {
+                vc::log::error("Synthetic board stopped after {} of {} instructions", run.instructions, batch);
+                return { };
+            }
+
+            point.instructions += run.instructions;
+            point.steadySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - steadyStart).count();
+        }
+
+        point.deviceTicks = board->getDeviceTicks() - startTicks;
+        point.allocations = vc::bench::getAllocationCount() - startAllocations;
+
+        return point;
+    }
+
+    [[nodiscard]]
+    std::optional<Sweep> runSweep(std::string_view dimension, const Options &options) {
+        Sweep sweep = { dimension, { } };
+
+        for (u32 value = 1; value <= options.maxSize; value *= 4) {
+            SyntheticBoardConfig config = { .devices = 2, .tracks = 1, .peripherals = 1 };
+            if (dimension == "devices")
+                config.devices = value;
+            else if (dimension == "tracks")
+                config.tracks = value;
+            else
+                config.peripherals = value;
+
+            auto point = measure(config, value, options);
+            if (!point.has_value())
+                return { };
+
+            vc::log::info("{:<12} {:6} {:10.3f} ms startup {:10.2f} ns/instruction {:8.2f} ticks/instruction {:10} KiB heap {:10} KiB resident",
+                dimension, value, point->startupSeconds * 1000, point->getNanosecondsPerInstruction(), point->getTicksPerInstruction(),
+                point->heapBytes / 1024, point->residentBytes / 1024);
+
+            sweep.points.push_back(*point);
+        }
+
+        return sweep;
+    }
+
+    /* Many boards per process, each one running on a single worker */
+    [[nodiscard]]
+    std::optional<std::vector<ThreadPoint>> runThreadSweep(const Options &options) {
+        std::vector<u32> workerCounts;
+        for (u32 workers = 1; workers < options.maxThreads; workers *= 2)
+            workerCounts.push_back(workers);
+        workerCounts.push_back(options.maxThreads);
+
+        std::vector<ThreadPoint> points;
+        for (auto workers : workerCounts) {
+            vc::pcb::Fleet fleet(options.fleetBoards, [](u32) -> std::unique_ptr<vc::pcb::Board> {
+                return createBoard({ .devices = 8, .tracks = 4, .peripherals = 2 });
+            });
+
+            fleet.setWorkerCount(workers);
+            fleet.setInstructionLimit(options.boardInstructions);
+            fleet.setSliceInstructions(std::max<u64>(options.boardInstructions / 4, 1));
+
+            const auto report = fleet.run();
+            if (report.getCount(vc::pcb::StopReason::InstructionLimit) != options.fleetBoards) {
+                vc::log::error("Not all boards of the fleet ran for {} instructions", options.boardInstructions);
+                return { };
+            }
+
+            const ThreadPoint point = { workers, report.seconds, report.getTotalInstructions(), report.steals };
+            vc::log::info("{:<12} {:6} {:10.2f} MIPS {:8.2f}x speedup {:8} steals", "threads", workers, point.getMIPS(), point.getMIPS() / (points.empty() ? point : points.front()).getMIPS(), point.steals);
+
+            points.push_back(point);
+        }
+
+        return points;
+    }
+
+    bool writeJson(const std::vector<Sweep> &sweeps, const std::vector<ThreadPoint> &threads, const Options &options) {
+        FILE *file = stdout;
+        if (*options.jsonPath != "-") {
+            file = fopen(std::string(*options.jsonPath).c_str(), "wb");
+            if (file == nullptr) {
+                vc::log::error("Failed to open '{}' for writing", *options.jsonPath);
+                return false;
+            }
+        }
+
+        fmt::print(file, "{{\n  \"benchmark\": \"scaling\",\n  \"sweeps\": [\n");
+        for (u32 i = 0; i < sweeps.size(); i++) {
+            fmt::print(file, "    {{ \"dimension\": \"{}\", \"points\": [\n", sweeps[i].dimension);
+
+            const auto &points = sweeps[i].points;
+            for (u32 j = 0; j < points.size(); j++) {
+                const auto &point = points[j];
+
+                fmt::print(file, "      {{ \"value\": {}, \"startup_seconds\": {:.6f}, \"ns_per_instruction\": {:.3f}, \"ticks_per_instruction\": {:.3f}, \"instructions\": {}, \"heap_bytes\": {}, \"resident_bytes\": {}, \"allocations\": {} }}{}\n",
+                    point.value, point.startupSeconds, point.getNanosecondsPerInstruction(), point.getTicksPerInstruction(), point.instructions,
+                    point.heapBytes, point.residentBytes, point.allocations, j + 1 < points.size() ? "," : "");
+            }
+
+            fmt::print(file, "    ] }}{}\n", i + 1 < sweeps.size() ? "," : "");
+        }
+
+        fmt::print(file, "  ],\n  \"threads\": [\n");
+        for (u32 i = 0; i < threads.size(); i++) {
+            const auto &point = threads[i];
+
+            fmt::print(file, "    {{ \"workers\": {}, \"boards\": {}, \"seconds\": {:.6f}, \"mips\": {:.3f}, \"speedup\": {:.3f}, \"steals\": {} }}{}\n",
+                point.workers, options.fleetBoards, point.seconds, point.getMIPS(), point.getMIPS() / threads.front().getMIPS(), point.steals,
+                i + 1 < threads.size() ? "," : "");
+        }
+        fmt::print(file, "  ]\n}}\n");
+
+        if (file != stdout)
+            fclose(file);
+
+        return true;
+    }
+
+    void printUsage(const char *name) {
+        fmt::print(stderr,
+            "Usage: {} [options]\n"
+            "  --max <n>                  Largest number of devices, tracks and peripherals to sweep up to in steps of four\n"
+            "  --min-time <seconds>       Wall time every board size gets simulated for at least\n"
+            "  --boards <n>               Number of boards in the thread sweep\n"
+            "  --board-instructions <n>   Instructions every board of the thread sweep runs\n"
+            "  --threads <n>              Largest number of workers in the thread sweep\n"
+            "  --filter <text>            Only run the sweeps whose name contains the text: devices, tracks, peripherals, threads\n"
+            "  --json <path>              Write the results as JSON, - for stdout\n",
+            name);
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--max" && hasValue)
+                options.maxSize = std::max(1UL, std::stoul(argv[++i]));
+            else if (argument == "--min-time" && hasValue)
+                options.minSeconds = std::stod(argv[++i]);
+            else if (argument == "--boards" && hasValue)
+                options.fleetBoards = std::max(1UL, std::stoul(argv[++i]));
+            else if (argument == "--board-instructions" && hasValue)
+                options.boardInstructions = std::max(1ULL, std::stoull(argv[++i], nullptr, 0));
+            else if (argument == "--threads" && hasValue)
+                options.maxThreads = std::max(1UL, std::stoul(argv[++i]));
+            else if (argument == "--filter" && hasValue)
+                options.filter = argv[++i];
+            else if (argument == "--json" && hasValue)
+                options.jsonPath = argv[++i];
+            else {
+                printUsage(argv[0]);
+                return ExitUsage;
+            }
+        } catch (const std::logic_error&) {
+            printUsage(argv[0]);
+            return ExitUsage;
+        }
+    }
+
+    auto selected = [&](std::string_view name) {
+        return !options.filter.has_value() || name.find(*options.filter) != std::string_view::npos;
+    };
+
+    std::vector<Sweep> sweeps;
+    for (auto dimension : { "devices", "tracks", "peripherals" }) {
+        if (!selected(dimension))
+            continue;
+
+        auto sweep = runSweep(dimension, options);
+        if (!sweep.has_value())
+            return ExitFailed;
+
+        sweeps.push_back(std::move(*sweep));
+    }
+
+    std::vector<ThreadPoint> threads;
+    if (selected("threads")) {
+        auto points = runThreadSweep(options);
+        if (!points.has_value())
+            return ExitFailed;
+
+        threads = std::move(*points);
+    }
+
+    if (options.jsonPath.has_value() && !writeJson(sweeps, threads, options))
+        return ExitUsage;
+
+    return 0;
+}
@@ -0,0 +1,626 @@
+#include <debug/gdb_server.hpp>
+
+#include <chrono>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace vc::debug {
+
+    namespace {
+
+        constexpr char InterruptCharacter = 0x03;
+        constexpr u32 RegisterCount = 33;
+        constexpr u32 PCRegister = 32;
+        constexpr auto PollInterval = std::chrono::milliseconds(20);
+
+        constexpr std::string_view RegisterNames[] = {
+            "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+            "fp", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+            "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+            "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+        };
+
+        [[nodiscard]]
+        std::string toHex(u64 value, u32 bytes) {
+            std::string result;
+            for (u32 i = 0; i < bytes; i++)
+                result += fmt::format("{:02x}", (value >> (i * 8)) & 0xFF);
+
+            return result;
+        }
+
+        [[nodiscard]]
+        u64 fromHex(std::string_view string) {
+            u64 value = 0;
+            for (char c : string) {
+                value <<= 4;
+                if (c >= '0' && c <= '9')      value |= c - '0';
+                else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            }
+
+            return value;
+        }
+
+        /* Registers are sent as little endian byte sequences */
+        [[nodiscard]]
+        u64 fromHexLittleEndian(std::string_view string) {
+            u64 value = 0;
+            for (u32 i = 0; i + 1 < string.size() && i < 16; i += 2)
+                value |= fromHex(string.substr(i, 2)) << (i * 4);
+
+            return value;
+        }
+
+        /* Monitor commands accept decimal as well as 0x prefixed hexadecimal numbers */
+        [[nodiscard]]
+        u64 parseNumber(std::string_view string) {
+            if (string.starts_with("0x"))
+                return fromHex(string.substr(2));
+
+            u64 value = 0;
+            for (char c : string) {
+                if (c < '0' || c > '9') break;
+                value = value * 10 + (c - '0');
+            }
+
+            return value;
+        }
+
+        [[nodiscard]]
+        std::string toHexString(std::string_view string) {
+            std::string result;
+            for (char c : string)
+                result += fmt::format("{:02x}", u8(c));
+
+            return result;
+        }
+
+        [[nodiscard]]
+        std::string fromHexString(std::string_view string) {
+            std::string result;
+            for (size_t i = 0; i + 1 < string.size(); i += 2)
+                result += char(fromHex(string.substr(i, 2)));
+
+            return result;
+        }
+
+        [[nodiscard]]
+        std::pair<u64, u64> parseRange(std::string_view string) {
+            auto comma = string.find(',');
+            return { fromHex(string.substr(0, comma)), fromHex(string.substr(comma + 1)) };
+        }
+
+    }
+
+    GDBServer::GDBServer(pcb::Board &board, dev::CPUDevice &cpu) : board(board), cpu(cpu) {
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).setBreakpoints(&this->breakpoints);
+
+        this->cpu.getAddressSpace().setWatchpoints(&this->watchpoints);
+    }
+
+    GDBServer::~GDBServer() {
+        this->stop();
+
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).setBreakpoints(nullptr);
+
+        this->cpu.getAddressSpace().setWatchpoints(nullptr);
+    }
+
+    bool GDBServer::listenTcp(u16 port) {
+        this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        if (this->listenSocket < 0) return false;
+
+        int reuse = 1;
+        setsockopt(this->listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address = { };
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(this->listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(this->listenSocket, 1) < 0) {
+            log::error("Failed to start GDB server on port {}: {}", port, strerror(errno));
+            close(this->listenSocket);
+            this->listenSocket = -1;
+            return false;
+        }
+
+        log::info("GDB server listening on localhost:{}", port);
+
+        this->running = true;
+        this->serverThread = std::thread([this] { this->serve(); });
+
+        return true;
+    }
+
+    bool GDBServer::listenUnix(std::string_view path) {
+        sockaddr_un address = { };
+        if (path.size() >= sizeof(address.sun_path)) return false;
+
+        this->listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (this->listenSocket < 0) return false;
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.data(), path.size());
+        unlink(address.sun_path);
+
+        if (bind(this->listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(this->listenSocket, 1) < 0) {
+            log::error("Failed to start GDB server on {}: {}", path, strerror(errno));
+            close(this->listenSocket);
+            this->listenSocket = -1;
+            return false;
+        }
+
+        log::info("GDB server listening on {}", path);
+
+        this->unixPath = path;
+        this->running = true;
+        this->serverThread = std::thread([this] { this->serve(); });
+
+        return true;
+    }
+
+    void GDBServer::stop() {
+        if (!this->running.exchange(false))
+            return;
+
+        this->serverThread.join();
+
+        close(this->listenSocket);
+        this->listenSocket = -1;
+
+        if (!this->unixPath.empty())
+            unlink(this->unixPath.c_str());
+    }
+
+    void GDBServer::serve() {
+        while (this->running) {
+            pollfd fd = { this->listenSocket, POLLIN, 0 };
+            if (poll(&fd, 1, PollInterval.count()) <= 0)
+                continue;
+
+            int client = accept(this->listenSocket, nullptr, nullptr);
+            if (client < 0)
+                continue;
+
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            log::info("GDB attached");
+            this->handleClient(client);
+            log::info("GDB detached");
+
+            close(client);
+        }
+    }
+
+    void GDBServer::handleClient(int client) {
+        this->receiveBuffer.clear();
+        this->selectedCore = 0;
+        this->interrupted = false;
+        this->pauseBoard();
+
+        while (this->running) {
+            auto packet = this->receivePacket(client);
+            if (!packet.has_value())
+                break;
+
+            if (*packet == "D" || *packet == "k") {
+                this->sendPacket(client, "OK");
+                break;
+            }
+
+            auto response = this->handlePacket(client, *packet);
+            this->sendPacket(client, response);
+        }
+
+        this->breakpoints.clear();
+        this->updateBreakpoints();
+        this->watchpoints.clear();
+        this->updateWatchpoints();
+        this->resumeCores(std::nullopt);
+    }
+
+    std::optional<std::string> GDBServer::receivePacket(int client) {
+        while (this->running) {
+            /* Drop acknowledgements and anything in front of the next packet */
+            auto start = this->receiveBuffer.find('$');
+            if (start != std::string::npos) {
+                auto end = this->receiveBuffer.find('#', start);
+                if (end != std::string::npos && end + 2 < this->receiveBuffer.size()) {
+                    auto packet = this->receiveBuffer.substr(start + 1, end - start - 1);
+                    this->receiveBuffer.erase(0, end + 3);
+
+                    send(client, "+", 1, MSG_NOSIGNAL);
+                    return packet;
+                }
+            } else {
+                this->receiveBuffer.clear();
+            }
+
+            pollfd fd = { client, POLLIN, 0 };
+            if (poll(&fd, 1, PollInterval.count()) <= 0)
+                continue;
+
+            char buffer[4096];
+            auto received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0)
+                return { };
+
+            this->receiveBuffer.append(buffer, received);
+        }
+
+        return { };
+    }
+
+    void GDBServer::sendPacket(int client, std::string_view data) {
+        u8 checksum = 0;
+        for (char c : data)
+            checksum += u8(c);
+
+        auto packet = fmt::format("${}#{:02x}", data, checksum);
+        send(client, packet.data(), packet.size(), MSG_NOSIGNAL);
+    }
+
+    std::string GDBServer::handlePacket(int client, std::string_view packet) {
+        auto &core = this->cpu.getCore(this->selectedCore);
+
+        switch (packet.empty() ? '\0' : packet[0]) {
+            case '?':
+                return this->stopReply();
+            case 'g':
+                return this->readRegisters();
+            case 'G':
+            {
+                auto &regs = core.getRegisters();
+                for (u32 i = 0; i < RegisterCount && (i + 1) * 16 <= packet.size() - 1; i++) {
+                    auto value = fromHexLittleEndian(packet.substr(1 + i * 16, 16));
+                    if (i == PCRegister)
+                        regs.pc = value;
+                    else
+                        regs.x[i] = value;
+                }
+
+                return "OK";
+            }
+            case 'p':
+            {
+                auto index = fromHex(packet.substr(1));
+                if (index >= RegisterCount) return "E01";
+
+                auto &regs = core.getRegisters();
+                return toHex(index == PCRegister ? regs.pc : u64(regs.x[index]), 8);
+            }
+            case 'P':
+            {
+                auto equals = packet.find('=');
+                auto index = fromHex(packet.substr(1, equals - 1));
+                if (index >= RegisterCount || equals == std::string_view::npos) return "E01";
+
+                auto &regs = core.getRegisters();
+                auto value = fromHexLittleEndian(packet.substr(equals + 1));
+                if (index == PCRegister)
+                    regs.pc = value;
+                else
+                    regs.x[index] = value;
+
+                return "OK";
+            }
+            case 'm':
+            {
+                auto [address, length] = parseRange(packet.substr(1));
+                return this->readMemory(address, length);
+            }
+            case 'M':
+            {
+                auto colon = packet.find(':');
+                if (colon == std::string_view::npos) return "E01";
+
+                auto [address, length] = parseRange(packet.substr(1, colon - 1));
+                auto data = packet.substr(colon + 1);
+
+                for (u64 i = 0; i < length && i * 2 + 1 < data.size(); i++) {
+                    if (!this->cpu.getAddressSpace().poke(address + i, fromHex(data.substr(i * 2, 2))))
+                        return "E14";
+                }
+
+                return "OK";
+            }
+            case 'c':
+            case 's':
+            {
+                if (packet.size() > 1)
+                    core.getRegisters().pc = fromHex(packet.substr(1));
+
+                return this->waitForStop(client, packet[0] == 's' ? std::optional(this->selectedCore) : std::nullopt);
+            }
+            case 'b':
+            {
+                if (this->timeMachine == nullptr || (packet != "bs" && packet != "bc"))
+                    return "";
+
+                const auto reached = packet == "bs" ? this->timeMachine->reverseStep(this->selectedCore) : this->timeMachine->reverseContinue(this->selectedCore);
+                if (!reached) {
+                    this->board.requestPause();
+                    return fmt::format("T05replaylog:begin;thread:{:x};", this->selectedCore + 1);
+                }
+
+                return this->stopReply();
+            }
+            case 'Z':
+            case 'z':
+            {
+                if (packet.size() < 4)
+                    return "";
+
+                auto [address, kind] = parseRange(packet.substr(3));
+
+                /* Software and hardware breakpoints are the same thing, memory never gets patched */
+                if (packet[1] == '0' || packet[1] == '1') {
+                    if (packet[0] == 'Z')
+                        this->breakpoints.add(address);
+                    else
+                        this->breakpoints.remove(address);
+
+                    this->updateBreakpoints();
+                    return "OK";
+                }
+
+                /* Write, read and access watchpoints, kind is the length of the watched range */
+                constexpr static dev::cpu::WatchpointType WatchpointTypes[] = { dev::cpu::WatchpointType::Write, dev::cpu::WatchpointType::Read, dev::cpu::WatchpointType::Access };
+                if (packet[1] < '2' || packet[1] > '4' || kind == 0)
+                    return "";
+
+                const auto type = WatchpointTypes[packet[1] - '2'];
+                if (packet[0] == 'Z')
+                    this->watchpoints.add({ address, kind, type, dev::cpu::WatchpointAction::Stop });
+                else
+                    this->watchpoints.remove(address, kind, type, dev::cpu::WatchpointAction::Stop);
+
+                this->updateWatchpoints();
+                return "OK";
+            }
+            case 'H':
+            {
+                /* Thread 0 and -1 mean any thread, keep the current one in that case */
+                auto thread = packet.substr(std::min<size_t>(2, packet.size()));
+                if (!thread.empty() && thread != "0" && thread != "-1") {
+                    auto id = fromHex(thread);
+                    if (id > 0 && id <= this->cpu.getCoreCount())
+                        this->selectedCore = id - 1;
+                }
+
+                return "OK";
+            }
+            case 'T':
+            {
+                auto thread = fromHex(packet.substr(1));
+                return thread > 0 && thread <= this->cpu.getCoreCount() ? "OK" : "E01";
+            }
+            case 'q':
+            {
+                if (packet.starts_with("qSupported"))
+                    return this->timeMachine != nullptr ? "PacketSize=4000;qXfer:features:read+;ReverseStep+;ReverseContinue+" : "PacketSize=4000;qXfer:features:read+";
+                if (packet == "qAttached")
+                    return "1";
+                if (packet == "qC")
+                    return fmt::format("QC{:x}", this->selectedCore + 1);
+                if (packet == "qfThreadInfo") {
+                    std::string threads = "m";
+                    for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+                        threads += fmt::format("{}{:x}", i == 0 ? "" : ",", i + 1);
+                    return threads;
+                }
+                if (packet == "qsThreadInfo")
+                    return "l";
+                if (packet.starts_with("qRcmd,"))
+                    return toHexString(this->handleMonitorCommand(fromHexString(packet.substr(6))));
+                if (packet.starts_with("qXfer:features:read:target.xml:")) {
+                    auto [offset, length] = parseRange(packet.substr(std::string_view("qXfer:features:read:target.xml:").size()));
+                    auto description = this->targetDescription();
+
+                    if (offset >= description.size())
+                        return "l";
+
+                    auto chunk = description.substr(offset, length);
+                    return (offset + chunk.size() < description.size() ? "m" : "l") + chunk;
+                }
+
+                return "";
+            }
+            default:
+                return "";
+        }
+    }
+
+    std::string GDBServer::waitForStop(int client, std::optional<u32> steppingCore) {
+        /* Sampled before resuming, the board might already be stopped again by the time we look */
+        const auto pauseCount = this->board.getPauseCount();
+        this->resumeCores(steppingCore);
+
+        while (this->running) {
+            if (this->board.isPaused() && this->board.getPauseCount() != pauseCount)
+                return this->stopReply();
+
+            pollfd fd = { client, POLLIN, 0 };
+            if (poll(&fd, 1, PollInterval.count()) <= 0)
+                continue;
+
+            char buffer[4096];
+            auto received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0)
+                break;
+
+            for (ssize_t i = 0; i < received; i++) {
+                if (buffer[i] == InterruptCharacter) {
+                    this->interrupted = true;
+
+                    /* A board that isn't running stops immediately */
+                    if (!this->board.isRunning())
+                        return this->stopReply();
+
+                    this->board.requestPause();
+                }
+            }
+        }
+
+        return "X00";
+    }
+
+    std::string GDBServer::stopReply() {
+        /* GDB considers the target stopped from now on, keep the board paused until it continues */
+        this->board.requestPause();
+
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++) {
+            auto &core = this->cpu.getCore(i);
+            if (!core.isDebugStopped())
+                continue;
+
+            this->selectedCore = i;
+            this->interrupted = false;
+
+            if (core.getStopReason() == dev::cpu::StopReason::Watchpoint) {
+                const auto &hit = core.getWatchpointHit();
+                const auto kind = hit.watchpoint == dev::cpu::WatchpointType::Write ? "watch" : hit.watchpoint == dev::cpu::WatchpointType::Read ? "rwatch" : "awatch";
+
+                return fmt::format("T05{}:{:x};thread:{:x};", kind, hit.address, i + 1);
+            }
+
+            return fmt::format("T05thread:{:x};", i + 1);
+        }
+
+        /* Nothing hit a breakpoint, either GDB interrupted the board or it got paused on attach */
+        return fmt::format("T{:02x}thread:{:x};", this->interrupted ? 2 : 5, this->selectedCore + 1);
+    }
+
+    void GDBServer::setTimeMachine(TimeMachine *timeMachine) {
+        this->timeMachine = timeMachine;
+    }
+
+    void GDBServer::pauseBoard() {
+        this->board.requestPause();
+
+        while (this->running && this->board.isRunning() && !this->board.isPaused())
+            std::this_thread::sleep_for(PollInterval);
+    }
+
+    void GDBServer::resumeCores(std::optional<u32> steppingCore) {
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).debugResume(steppingCore == i);
+
+        this->interrupted = false;
+        this->board.resume();
+    }
+
+    void GDBServer::updateBreakpoints() {
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).setBreakpoints(&this->breakpoints);
+    }
+
+    void GDBServer::updateWatchpoints() {
+        this->cpu.getAddressSpace().setWatchpoints(&this->watchpoints);
+    }
+
+    std::string GDBServer::handleMonitorCommand(std::string_view command) {
+        /* trace <address> <length> [r|w|a] records accesses without stopping, hits lists and drains what got recorded so far */
+        if (command.starts_with("trace ")) {
+            auto arguments = command.substr(6);
+            auto separator = arguments.find(' ');
+            if (separator == std::string_view::npos)
+                return "Usage: trace <address> <length> [r|w|a]\n";
+
+            const auto address = parseNumber(arguments.substr(0, separator));
+            arguments = arguments.substr(separator + 1);
+            separator = arguments.find(' ');
+            const auto length = parseNumber(arguments.substr(0, separator));
+
+            auto type = dev::cpu::WatchpointType::Write;
+            if (separator != std::string_view::npos) {
+                switch (arguments[separator + 1]) {
+                    case 'r': type = dev::cpu::WatchpointType::Read;   break;
+                    case 'a': type = dev::cpu::WatchpointType::Access; break;
+                    default: break;
+                }
+            }
+
+            if (length == 0)
+                return "Length must not be zero\n";
+
+            this->watchpoints.add({ address, length, type, dev::cpu::WatchpointAction::Record });
+            this->updateWatchpoints();
+
+            return fmt::format("Tracing 0x{:x} - 0x{:x}\n", address, address + length - 1);
+        } else if (command == "untrace") {
+            this->watchpoints.remove(dev::cpu::WatchpointAction::Record);
+            this->updateWatchpoints();
+
+            return "Removed all traces\n";
+        } else if (command == "hits") {
+            std::string result;
+            while (auto hit = this->watchpoints.popHit())
+                result += fmt::format("pc 0x{:016x}: {} {} bytes at 0x{:x} = 0x{:x}\n", hit->pc, hit->access == dev::cpu::WatchpointType::Read ? "read " : "write", hit->size, hit->address, hit->value);
+
+            if (auto dropped = this->watchpoints.getDroppedHits(); dropped > 0)
+                result += fmt::format("{} hits dropped in total\n", dropped);
+
+            return result.empty() ? "No hits recorded\n" : result;
+        } else if (command == "history") {
+            if (this->timeMachine == nullptr)
+                return "Reverse execution is disabled\n";
+
+            return fmt::format("{} checkpoints every {} ticks, {} KiB\n", this->timeMachine->getCheckpointCount(), this->timeMachine->getCheckpointInterval(), this->timeMachine->getMemoryUsage() / 1024);
+        }
+
+        return "Commands: trace <address> <length> [r|w|a], untrace, hits, history\n";
+    }
+
+    std::string GDBServer::readRegisters() {
+        auto &regs = this->cpu.getCore(this->selectedCore).getRegisters();
+
+        std::string result;
+        for (u8 i = 0; i < 32; i++)
+            result += toHex(regs.x[i], 8);
+        result += toHex(regs.pc, 8);
+
+        return result;
+    }
+
+    std::string GDBServer::readMemory(u64 address, u64 length) {
+        std::string result;
+
+        for (u64 i = 0; i < length; i++) {
+            auto value = this->cpu.getAddressSpace().peek(address + i);
+            if (!value.has_value())
+                return result.empty() ? "E14" : result;
+
+            result += fmt::format("{:02x}", *value);
+        }
+
+        return result;
+    }
+
+    std::string GDBServer::targetDescription() const {
+        std::string description = R"(<?xml version="1.0"?><!DOCTYPE target SYSTEM "gdb-target.dtd"><target version="1.0"><architecture>riscv:rv64</architecture><feature name="org.gnu.gdb.riscv.cpu">)";
+
+        for (u32 i = 0; i < 32; i++)
+            description += fmt::format(R"(<reg name="{}" bitsize="64" type="{}" regnum="{}"/>)", RegisterNames[i], i == 1 || i == 2 || i == 8 ? (i == 1 ? "code_ptr" : "data_ptr") : "int", i);
+        description += fmt::format(R"(<reg name="pc" bitsize="64" type="code_ptr" regnum="{}"/>)", PCRegister);
+
+        description += "</feature></target>";
+
+        return description;
+    }
+
+}
@@ -0,0 +1,114 @@
+#include <debug/profiler.hpp>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+#include <fmt/format.h>
+
+namespace vc::debug {
+
+    namespace {
+
+        /* Functions making up the stack of every node of a profile, outermost first. Parents always got created before their children */
+        std::vector<std::vector<std::string>> resolveStacks(const dev::cpu::Profile &profile, const SymbolTable &symbols) {
+            const auto &nodes = profile.getNodes();
+
+            std::vector<std::vector<std::string>> stacks(nodes.size());
+            for (u32 node = 1; node < nodes.size(); node++) {
+                stacks[node] = stacks[nodes[node].parent];
+                stacks[node].push_back(symbols.getName(nodes[node].callSite));
+            }
+
+            return stacks;
+        }
+
+        double percentOf(u64 value, u64 total) {
+            return total == 0 ? 0.0 : double(value) * 100.0 / double(total);
+        }
+
+    }
+
+    Profiler::Profiler(dev::CPUDevice &cpu, u32 interval) : cpu(cpu) {
+        for (u32 core = 0; core < cpu.getCoreCount(); core++) {
+            auto &profile = this->profiles.emplace_back(std::make_unique<dev::cpu::Profile>(interval));
+            cpu.getCore(core).setProfile(profile.get());
+        }
+    }
+
+    Profiler::~Profiler() {
+        for (u32 core = 0; core < this->cpu.getCoreCount(); core++)
+            this->cpu.getCore(core).setProfile(nullptr);
+    }
+
+    u64 Profiler::getSampleCount() const {
+        u64 count = 0;
+        for (const auto &profile : this->profiles)
+            count += profile->getSampleCount();
+
+        return count;
+    }
+
+    void Profiler::writeFlatProfile(FILE *file, const SymbolTable &symbols) const {
+        struct Entry {
+            u64 self = 0, total = 0;
+        };
+
+        for (u32 core = 0; core < this->profiles.size(); core++) {
+            const auto &profile = *this->profiles[core];
+            const auto stacks = resolveStacks(profile, symbols);
+
+            std::map<std::string, Entry> entries;
+            for (const auto &[sample, count] : profile.getSamples()) {
+                auto leaf = symbols.getName(sample.pc);
+                entries[leaf].self += count;
+
+                /* Recursive functions only count once per sample towards their total */
+                std::set<std::string_view> seen = { leaf };
+                entries[leaf].total += count;
+                for (const auto &function : stacks[sample.node]) {
+                    if (seen.insert(function).second)
+                        entries[function].total += count;
+                }
+            }
+
+            std::vector<std::pair<std::string, Entry>> sorted(entries.begin(), entries.end());
+            std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+                return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+            });
+
+            const auto samples = profile.getSampleCount();
+            fmt::print(file, "Hart {}: {} samples, one every {} instructions\n", core, samples, profile.getInterval());
+            fmt::print(file, "{:>10} {:>8} {:>10} {:>8}  {}\n", "self", "self %", "total", "total %", "function");
+            for (const auto &[name, entry] : sorted)
+                fmt::print(file, "{:>10} {:>7.2f}% {:>10} {:>7.2f}%  {}\n", entry.self, percentOf(entry.self, samples), entry.total, percentOf(entry.total, samples), name);
+            fmt::print(file, "\n");
+        }
+    }
+
+    void Profiler::writeCollapsedStacks(FILE *file, const SymbolTable &symbols) const {
+        std::map<std::string, u64> collapsed;
+
+        for (u32 core = 0; core < this->profiles.size(); core++) {
+            const auto &profile = *this->profiles[core];
+            const auto stacks = resolveStacks(profile, symbols);
+
+            /* Harts only get their own root frame if there's more than one of them */
+            const auto root = this->profiles.size() > 1 ? fmt::format("hart{};", core) : std::string();
+
+            for (const auto &[sample, count] : profile.getSamples()) {
+                auto line = root;
+                for (const auto &function : stacks[sample.node])
+                    line += function + ";";
+                line += symbols.getName(sample.pc);
+
+                collapsed[line] += count;
+            }
+        }
+
+        for (const auto &[stack, count] : collapsed)
+            fmt::print(file, "{} {}\n", stack, count);
+    }
+
+}
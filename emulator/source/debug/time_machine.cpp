@@ -0,0 +1,295 @@
+#include <debug/time_machine.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <thread>
+
+namespace vc::debug {
+
+    namespace {
+
+        constexpr auto PollInterval = std::chrono::microseconds(200);
+
+    }
+
+    TimeMachine::TimeMachine(pcb::Board &board, dev::CPUDevice &cpu) : board(board), cpu(cpu) {
+        for (auto &mmio : cpu.getAddressSpace().getDevices()) {
+            if (auto memory = dynamic_cast<dev::cpu::mmio::Memory*>(mmio); memory != nullptr) {
+                auto &region = this->regions.emplace_back(memory, std::make_unique<util::DirtyBitmap>(memory->getSize(), PageSize));
+                memory->addWriteTracker(*region.tracker);
+            }
+        }
+
+        board.setWindowListener([this] { this->onWindow(); });
+    }
+
+    TimeMachine::~TimeMachine() {
+        this->board.setWindowListener(nullptr);
+
+        for (auto &region : this->regions)
+            region.memory->removeWriteTracker(*region.tracker);
+    }
+
+    void TimeMachine::setLatencyTarget(std::chrono::milliseconds latency) {
+        this->latencyTarget = latency;
+    }
+
+    void TimeMachine::setMemoryLimit(size_t bytes) {
+        this->memoryLimit = bytes;
+    }
+
+    bool TimeMachine::reverseStep(u32 core) {
+        if (!this->board.isPaused()) return false;
+
+        const auto position = this->cpu.getRetiredInstructions(core);
+        auto index = this->findCheckpoint(core, position == 0 ? 0 : position - 1);
+        if (position == 0 || !index.has_value())
+            return false;
+
+        this->restore(*index);
+        return this->replayTo(core, position - 1);
+    }
+
+    bool TimeMachine::reverseContinue(u32 core) {
+        if (!this->board.isPaused()) return false;
+
+        auto end = this->cpu.getRetiredInstructions(core);
+        auto index = this->findCheckpoint(core, end == 0 ? 0 : end - 1);
+        if (end == 0 || !index.has_value())
+            return false;
+
+        /* Replay the history one checkpoint interval at a time, going further back until the last breakpoint or watchpoint in front of the current position shows up */
+        while (true) {
+            const auto start = this->checkpoints[*index].positions[core];
+
+            this->restore(*index);
+            this->replayTo(core, end);
+
+            if (auto hit = this->cpu.getCore(core).getLastHit(); hit.has_value()) {
+                this->restore(*index);
+                this->replayTo(core, hit->position);
+
+                /* Don't trip over the same watchpoint again when continuing forward from here */
+                if (hit->watchpointAddress.has_value())
+                    this->cpu.getCore(core).skipWatchpoint(*hit->watchpointAddress);
+
+                return true;
+            }
+
+            if (*index == 0) {
+                this->restore(0);
+                return false;
+            }
+
+            end = start;
+            *index -= 1;
+        }
+    }
+
+    size_t TimeMachine::getCheckpointCount() const {
+        return this->checkpoints.size();
+    }
+
+    size_t TimeMachine::getMemoryUsage() const {
+        return this->memoryUsage;
+    }
+
+    u64 TimeMachine::getCheckpointInterval() const {
+        return this->interval;
+    }
+
+    void TimeMachine::onWindow() {
+        const auto now = std::chrono::steady_clock::now();
+        const auto time = this->board.getVirtualTime();
+        const auto pauseCount = this->board.getPauseCount();
+
+        if (pauseCount == this->lastPauseCount && time > this->lastWindowTime) {
+            this->measuredTicks += time - this->lastWindowTime;
+            this->measuredDuration += now - this->lastWindow;
+        }
+
+        this->lastWindow = now;
+        this->lastWindowTime = time;
+        this->lastPauseCount = pauseCount;
+
+        /* Virtual time only ever goes back on its own when the board got powered up again */
+        if (this->checkpoints.empty() || time < this->checkpoints.back().time)
+            this->startHistory();
+        else if (time - this->checkpoints.back().time >= this->interval)
+            this->takeCheckpoint();
+
+        if (this->replayTarget.has_value()) {
+            const auto &[core, position] = *this->replayTarget;
+            if (this->cpu.getCore(core).isHalted() || this->cpu.getRetiredInstructions(core) >= position)
+                this->board.requestPause();
+        }
+    }
+
+    void TimeMachine::startHistory() {
+        this->checkpoints.clear();
+        this->memoryUsage = 0;
+
+        for (auto &region : this->regions) {
+            const auto data = region.memory->getData();
+            region.base.assign(data.begin(), data.end());
+            region.tracker->clear();
+        }
+
+        this->takeCheckpoint();
+    }
+
+    void TimeMachine::takeCheckpoint() {
+        auto &checkpoint = this->checkpoints.emplace_back();
+        checkpoint.time = this->board.getVirtualTime();
+
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            checkpoint.positions.push_back(this->cpu.getRetiredInstructions(i));
+
+        util::StateWriter state;
+        this->board.saveState(state);
+        checkpoint.state = std::move(state.getData());
+
+        for (u32 i = 0; i < this->regions.size(); i++) {
+            const auto data = this->regions[i].memory->getData();
+
+            this->regions[i].tracker->consume([&](u64 page) {
+                const auto offset = page * PageSize;
+                const auto size = std::min<u64>(PageSize, data.size() - offset);
+
+                checkpoint.pages.push_back({ i, page, { data.begin() + offset, data.begin() + offset + size } });
+            });
+        }
+
+        this->memoryUsage += getSize(checkpoint);
+
+        /* Indices into the history have to stay stable while it's being replayed */
+        if (!this->replayTarget.has_value()) {
+            while (this->memoryUsage > this->memoryLimit && this->checkpoints.size() > 1)
+                this->dropOldestCheckpoint();
+        }
+
+        /* Space the next checkpoint so replaying up to it takes about half the latency target */
+        if (this->measuredDuration.count() > 0) {
+            const auto ticksPerSecond = double(this->measuredTicks) / std::chrono::duration<double>(this->measuredDuration).count();
+            this->interval = u64(ticksPerSecond * std::chrono::duration<double>(this->latencyTarget).count() / 2);
+
+            this->measuredTicks = 0;
+            this->measuredDuration = { };
+        }
+    }
+
+    void TimeMachine::dropOldestCheckpoint() {
+        this->memoryUsage -= getSize(this->checkpoints.front());
+        this->checkpoints.pop_front();
+
+        /* The new oldest checkpoint's pages become part of the base image */
+        auto &oldest = this->checkpoints.front();
+        this->memoryUsage -= getSize(oldest);
+
+        for (const auto &copy : oldest.pages)
+            std::memcpy(this->regions[copy.region].base.data() + copy.page * PageSize, copy.data.data(), copy.data.size());
+        oldest.pages.clear();
+
+        this->memoryUsage += getSize(oldest);
+
+        /* Nothing can be rewound to a point in front of the oldest checkpoint anymore, so neither can the inputs applied there */
+        this->board.dropInputsBefore(oldest.time);
+    }
+
+    void TimeMachine::restore(size_t index) {
+        /* Pages that changed since the checkpoint, either written to since the last one or saved by any of the ones after it */
+        std::set<std::pair<u32, u64>> changed;
+
+        for (u32 i = 0; i < this->regions.size(); i++)
+            this->regions[i].tracker->consume([&](u64 page) { changed.insert({ i, page }); });
+
+        for (size_t i = index + 1; i < this->checkpoints.size(); i++) {
+            for (const auto &copy : this->checkpoints[i].pages)
+                changed.insert({ copy.region, copy.page });
+
+            this->memoryUsage -= getSize(this->checkpoints[i]);
+        }
+        this->checkpoints.erase(this->checkpoints.begin() + index + 1, this->checkpoints.end());
+
+        auto restorePage = [this](u32 regionIndex, u64 page, const u8 *source) {
+            auto &region = this->regions[regionIndex];
+            const auto offset = page * PageSize;
+            const auto size = std::min<u64>(PageSize, region.base.size() - offset);
+
+            std::memcpy(region.memory->getData().data() + offset, source, size);
+            region.memory->markWritten(offset, size);
+        };
+
+        /* The newest copy of a page at or before the checkpoint holds its contents at that time, pages that never got copied are still the same as in the base image */
+        for (size_t i = index + 1; i > 0 && !changed.empty(); i--) {
+            for (const auto &copy : this->checkpoints[i - 1].pages) {
+                if (changed.erase({ copy.region, copy.page }) > 0)
+                    restorePage(copy.region, copy.page, copy.data.data());
+            }
+        }
+
+        for (const auto &[region, page] : changed)
+            restorePage(region, page, this->regions[region].base.data() + page * PageSize);
+
+        for (auto &region : this->regions)
+            region.tracker->clear();
+
+        const auto &checkpoint = this->checkpoints[index];
+        util::StateReader state(checkpoint.state);
+        this->board.loadState(state);
+        this->board.rewindInputs(checkpoint.time);
+
+        this->lastWindowTime = checkpoint.time;
+    }
+
+    std::optional<size_t> TimeMachine::findCheckpoint(u32 core, u64 position) const {
+        for (size_t i = this->checkpoints.size(); i > 0; i--) {
+            if (this->checkpoints[i - 1].positions[core] <= position)
+                return i - 1;
+        }
+
+        return std::nullopt;
+    }
+
+    bool TimeMachine::replayTo(u32 core, u64 position) {
+        auto &target = this->cpu.getCore(core);
+
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).setReplaying(true);
+
+        if (target.getRetiredInstructions() != position) {
+            for (u32 i = 0; i < this->cpu.getCoreCount(); i++) {
+                if (i == core)
+                    target.debugResumeUntil(position);
+                else
+                    this->cpu.getCore(i).debugResume(false);
+            }
+
+            this->replayTarget = { core, position };
+
+            const auto pauseCount = this->board.getPauseCount();
+            this->board.resume();
+
+            while (this->board.isRunning() && !(this->board.isPaused() && this->board.getPauseCount() != pauseCount))
+                std::this_thread::sleep_for(PollInterval);
+
+            this->board.requestPause();
+            this->replayTarget.reset();
+        }
+
+        for (u32 i = 0; i < this->cpu.getCoreCount(); i++)
+            this->cpu.getCore(i).setReplaying(false);
+
+        return target.getRetiredInstructions() == position;
+    }
+
+    size_t TimeMachine::getSize(const Checkpoint &checkpoint) {
+        size_t size = checkpoint.state.size();
+        for (const auto &copy : checkpoint.pages)
+            size += copy.data.size();
+
+        return size;
+    }
+
+}
@@ -1,6 +1,10 @@
 #include <devices/cpu/core/core.hpp>
 #include <utils.hpp>
 
+#include <array>
+#include <limits>
+#include <utility>
+
 #define INSTRUCTION(category, type, ...) { .category = { .type = { __VA_ARGS__ } } }
 
 #define INSTR_LOG(fmt, ...) log::debug("({:#x}) " fmt, regs.pc, __VA_ARGS__)
@@ -13,8 +17,59 @@ namespace vc::dev::cpu {
     }
 
     void Core::execute() {
-        if (this->halted) return;
+        if (this->halted || this->stopReason != StopReason::None) return;
+
+        if (const auto page = regs.pc >> Breakpoints::PageShift; page != this->breakpointPage) [[unlikely]] {
+            this->breakpointPage = page;
+            this->breakpointsInPage = this->breakpoints != nullptr && this->breakpoints->hasBreakpointsInPage(page);
+        }
+
+        if (this->breakpointsInPage) [[unlikely]] {
+            if (!std::exchange(this->skipBreakpoint, false) && this->breakpoints->contains(regs.pc)) {
+                if (!this->replaying) {
+                    this->stopReason = StopReason::Breakpoint;
+                    return;
+                }
+
+                this->lastHit = ReplayHit { this->getRetiredInstructions(), { } };
+            }
+        }
+
+        try {
+            this->executeNext();
+        } catch (WatchpointException &exception) {
+            exception.hit.pc = regs.pc;
+
+            /* The instruction gets executed again later on, its access mustn't trigger a second time */
+            this->skipWatchpoint(exception.hit.address);
+
+            if (exception.action == WatchpointAction::Stop) {
+                if (!this->replaying) {
+                    this->watchpointHit = exception.hit;
+                    this->stopReason = StopReason::Watchpoint;
+                    return;
+                }
 
+                this->lastHit = ReplayHit { this->getRetiredInstructions(), exception.hit.address };
+            } else if (!this->replaying) {
+                /* Accesses that got replayed have already been recorded the first time around */
+                this->addressSpace.getWatchpoints()->record(exception.hit);
+            }
+
+            this->executeNext();
+        }
+
+        /* A skip that didn't get used up by its instruction mustn't swallow a later hit */
+        if (this->skippedWatchpoint.has_value()) [[unlikely]]
+            this->skippedWatchpoint.reset();
+
+        if (this->getRetiredInstructions() == this->stopPosition) [[unlikely]] {
+            this->stopPosition = NoPosition;
+            this->stopReason = StopReason::Step;
+        }
+    }
+
+    void Core::executeNext() {
         auto opcode = getOpcode(this->addressSpace(regs.pc, byte_tag()));
 
         /* Check if instruction is compressed */
@@ -32,11 +87,21 @@ namespace vc::dev::cpu {
 
         addressSpace.tickDevices();
 
+        if (this->profile != nullptr && !this->replaying) [[unlikely]]
+            this->profile->retire(regs.pc);
+
         regs.pc = this->nextPC;
+        this->retiredInstructions.add();
     }
 
     constexpr void Core::executeInstruction(const Instruction &instr) {
         switch (instr.getOpcode()) {
+            case Opcode::OP:
+                executeOPInstruction(instr);
+                break;
+            case Opcode::OP_32:
+                executeOP32Instruction(instr);
+                break;
             case Opcode::OP_IMM:
                 executeOPIMMInstruction(instr);
                 break;
@@ -53,7 +118,7 @@ namespace vc::dev::cpu {
             {
                 auto &i = instr.Base.U;
                 INSTR_LOG("AUIPC x{}, #{:#x}", i.rd, i.getImmediate());
-                regs.x[i.rd] = regs.pc + i.getImmediate();
+                regs.x[i.rd] = regs.pc + util::signExtend<32, i64>(i.getImmediate());
                 break;
             }
             case Opcode::JAL:
@@ -65,6 +130,9 @@ namespace vc::dev::cpu {
                 this->nextPC = regs.pc + util::signExtend<20, i64>(i.getImmediate()) * 2;
                 regs.x[i.rd] = link;
 
+                if (this->profile != nullptr && !this->replaying) [[unlikely]]
+                    this->profile->jump(regs.pc, i.rd, std::nullopt);
+
                 break;
             }
             case Opcode::JALR:
@@ -76,6 +144,9 @@ namespace vc::dev::cpu {
                 this->nextPC = (util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1]) & u64(~0b1);
                 regs.x[i.rd] = link;
 
+                if (this->profile != nullptr && !this->replaying) [[unlikely]]
+                    this->profile->jump(regs.pc, i.rd, i.rs1);
+
                 break;
             }
             case Opcode::BRANCH:
@@ -84,27 +155,234 @@ namespace vc::dev::cpu {
             case Opcode::LUI:
             {
                 auto &i = instr.Base.U;
-                INSTR_LOG("LUI x{}, #{:#x}", i.rd, util::signExtend<20, i64>(i.getImmediate()));
-                regs.x[i.rd] = util::signExtend<12, u64>(i.getImmediate());
+                INSTR_LOG("LUI x{}, #{:#x}", i.rd, i.getImmediate() >> 12);
+                regs.x[i.rd] = util::signExtend<32, i64>(i.getImmediate());
                 break;
             }
 
-            default: this->halt("Invalid instruction {:x}", instr.getOpcode());
+            default: this->halt("Invalid instruction {:x}", u8(instr.getOpcode()));
         }
     }
 
     constexpr void Core::executeOPInstruction(const Instruction &instr) {
         const auto &i = instr.Base.R;
+        const u64 rs1 = regs.x[i.rs1], rs2 = regs.x[i.rs2];
 
-        #define IS_FUNC(instruction, type) (instruction.funct3 == instr_t(OPFunc3::type) && instruction.funct7 == instr_t(OPFunc7::type))
+        #define FUNC(type) ((instr_t(OPFunc7::type) << 3) | instr_t(OPFunc3::type))
 
-        if (IS_FUNC(i, ADD)) {
-            regs.x[i.rd] = regs.x[i.rs1] + regs.x[i.rs2];
-        } else {
-            this->halt("Invalid OP function {:x} {:x}", i.funct3, i.funct7);
+        /* Division by zero and overflow don't trap, they return the values the specification defines */
+        switch ((i.funct7 << 3) | i.funct3) {
+            case FUNC(ADD):
+            {
+                INSTR_LOG("ADD x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 + rs2;
+                break;
+            }
+            case FUNC(SUB):
+            {
+                INSTR_LOG("SUB x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 - rs2;
+                break;
+            }
+            case FUNC(SLL):
+            {
+                INSTR_LOG("SLL x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 << (rs2 & 0x3F);
+                break;
+            }
+            case FUNC(SLT):
+            {
+                INSTR_LOG("SLT x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = i64(rs1) < i64(rs2) ? 1 : 0;
+                break;
+            }
+            case FUNC(SLTU):
+            {
+                INSTR_LOG("SLTU x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 < rs2 ? 1 : 0;
+                break;
+            }
+            case FUNC(XOR):
+            {
+                INSTR_LOG("XOR x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 ^ rs2;
+                break;
+            }
+            case FUNC(SRL):
+            {
+                INSTR_LOG("SRL x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 >> (rs2 & 0x3F);
+                break;
+            }
+            case FUNC(SRA):
+            {
+                INSTR_LOG("SRA x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = i64(rs1) >> (rs2 & 0x3F);
+                break;
+            }
+            case FUNC(OR):
+            {
+                INSTR_LOG("OR x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 | rs2;
+                break;
+            }
+            case FUNC(AND):
+            {
+                INSTR_LOG("AND x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 & rs2;
+                break;
+            }
+            case FUNC(MUL):
+            {
+                INSTR_LOG("MUL x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs1 * rs2;
+                break;
+            }
+            case FUNC(MULH):
+            {
+                INSTR_LOG("MULH x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = u64((i128(i64(rs1)) * i128(i64(rs2))) >> 64);
+                break;
+            }
+            case FUNC(MULHSU):
+            {
+                INSTR_LOG("MULHSU x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = u64((i128(i64(rs1)) * i128(rs2)) >> 64);
+                break;
+            }
+            case FUNC(MULHU):
+            {
+                INSTR_LOG("MULHU x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = u64((u128(rs1) * u128(rs2)) >> 64);
+                break;
+            }
+            case FUNC(DIV):
+            {
+                INSTR_LOG("DIV x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                if (rs2 == 0)
+                    regs.x[i.rd] = ~u64(0);
+                else if (i64(rs1) == std::numeric_limits<i64>::min() && i64(rs2) == -1)
+                    regs.x[i.rd] = rs1;
+                else
+                    regs.x[i.rd] = i64(rs1) / i64(rs2);
+                break;
+            }
+            case FUNC(DIVU):
+            {
+                INSTR_LOG("DIVU x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs2 == 0 ? ~u64(0) : rs1 / rs2;
+                break;
+            }
+            case FUNC(REM):
+            {
+                INSTR_LOG("REM x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                if (rs2 == 0)
+                    regs.x[i.rd] = rs1;
+                else if (i64(rs1) == std::numeric_limits<i64>::min() && i64(rs2) == -1)
+                    regs.x[i.rd] = 0;
+                else
+                    regs.x[i.rd] = i64(rs1) % i64(rs2);
+                break;
+            }
+            case FUNC(REMU):
+            {
+                INSTR_LOG("REMU x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                regs.x[i.rd] = rs2 == 0 ? rs1 : rs1 % rs2;
+                break;
+            }
+            default: this->halt("Invalid OP function {:x} {:x}", i.funct3, i.funct7);
         }
 
-        #undef IS_FUNC
+        #undef FUNC
+    }
+
+    constexpr void Core::executeOP32Instruction(const Instruction &instr) {
+        const auto &i = instr.Base.R;
+        const u32 rs1 = regs.x[i.rs1], rs2 = regs.x[i.rs2];
+
+        #define FUNC(type) ((instr_t(OP32Func7::type) << 3) | instr_t(OP32Func3::type))
+
+        /* Only the lower words get looked at, the result gets sign extended from 32 bits */
+        u32 result = 0;
+        switch ((i.funct7 << 3) | i.funct3) {
+            case FUNC(ADDW):
+            {
+                INSTR_LOG("ADDW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs1 + rs2;
+                break;
+            }
+            case FUNC(SUBW):
+            {
+                INSTR_LOG("SUBW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs1 - rs2;
+                break;
+            }
+            case FUNC(SLLW):
+            {
+                INSTR_LOG("SLLW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs1 << (rs2 & 0x1F);
+                break;
+            }
+            case FUNC(SRLW):
+            {
+                INSTR_LOG("SRLW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs1 >> (rs2 & 0x1F);
+                break;
+            }
+            case FUNC(SRAW):
+            {
+                INSTR_LOG("SRAW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = i32(rs1) >> (rs2 & 0x1F);
+                break;
+            }
+            case FUNC(MULW):
+            {
+                INSTR_LOG("MULW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs1 * rs2;
+                break;
+            }
+            case FUNC(DIVW):
+            {
+                INSTR_LOG("DIVW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                if (rs2 == 0)
+                    result = ~u32(0);
+                else if (i32(rs1) == std::numeric_limits<i32>::min() && i32(rs2) == -1)
+                    result = rs1;
+                else
+                    result = i32(rs1) / i32(rs2);
+                break;
+            }
+            case FUNC(DIVUW):
+            {
+                INSTR_LOG("DIVUW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs2 == 0 ? ~u32(0) : rs1 / rs2;
+                break;
+            }
+            case FUNC(REMW):
+            {
+                INSTR_LOG("REMW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                if (rs2 == 0)
+                    result = rs1;
+                else if (i32(rs1) == std::numeric_limits<i32>::min() && i32(rs2) == -1)
+                    result = 0;
+                else
+                    result = i32(rs1) % i32(rs2);
+                break;
+            }
+            case FUNC(REMUW):
+            {
+                INSTR_LOG("REMUW x{}, x{}, x{}", i.rd, i.rs1, i.rs2);
+                result = rs2 == 0 ? rs1 : rs1 % rs2;
+                break;
+            }
+            default:
+                this->halt("Invalid OP32 function {:x} {:x}", i.funct3, i.funct7);
+                return;
+        }
+
+        regs.x[i.rd] = util::signExtend<32, i64>(result);
+
+        #undef FUNC
     }
 
     constexpr void Core::executeOPIMMInstruction(const Instruction &instr) {
@@ -135,6 +413,40 @@ namespace vc::dev::cpu {
                 regs.x[i.rd] = regs.x[i.rs1] & util::signExtend<12, i64>(i.getImmediate());
                 break;
             }
+            case OPIMMFunc::SLTI:
+            {
+                INSTR_LOG("SLTI x{}, x{}, #{:#x}", i.rd, i.rs1, util::signExtend<12, i64>(i.getImmediate()));
+                regs.x[i.rd] = i64(regs.x[i.rs1]) < util::signExtend<12, i64>(i.getImmediate()) ? 1 : 0;
+                break;
+            }
+            case OPIMMFunc::SLTIU:
+            {
+                INSTR_LOG("SLTIU x{}, x{}, #{:#x}", i.rd, i.rs1, util::signExtend<12, i64>(i.getImmediate()));
+                regs.x[i.rd] = u64(regs.x[i.rs1]) < util::signExtend<12, u64>(i.getImmediate()) ? 1 : 0;
+                break;
+            }
+            case OPIMMFunc::SLLI:
+            {
+                INSTR_LOG("SLLI x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x3F);
+                if ((i.getImmediate() >> 6) != u32(ShiftFunc::Logical))
+                    this->halt("Invalid SLLI shift function {:x}", i.getImmediate() >> 6);
+
+                regs.x[i.rd] = regs.x[i.rs1] << (i.getImmediate() & 0x3F);
+                break;
+            }
+            case OPIMMFunc::SRLI_SRAI:
+            {
+                if ((i.getImmediate() >> 6) == u32(ShiftFunc::Logical)) {
+                    INSTR_LOG("SRLI x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x3F);
+                    regs.x[i.rd] = regs.x[i.rs1] >> (i.getImmediate() & 0x3F);
+                } else if ((i.getImmediate() >> 6) == u32(ShiftFunc::Arithmetic)) {
+                    INSTR_LOG("SRAI x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x3F);
+                    regs.x[i.rd] = i64(regs.x[i.rs1]) >> (i.getImmediate() & 0x3F);
+                } else {
+                    this->halt("Invalid right shift function {:x}", i.getImmediate() >> 6);
+                }
+                break;
+            }
             default: this->halt("Invalid OPIMM function {:x}", instr.getFunction3());
         }
     }
@@ -142,6 +454,7 @@ namespace vc::dev::cpu {
     constexpr void Core::executeOPIMM32Instruction(const Instruction &instr) {
         const auto &i = instr.Base.I;
 
+        /* Word shifts only have five shift amount bits, the sixth one has to stay clear like the function bits above it */
         switch (static_cast<OPIMM32Func>(instr.getFunction3())) {
             case OPIMM32Func::ADDIW:
             {
@@ -149,56 +462,127 @@ namespace vc::dev::cpu {
                 regs.x[i.rd] = util::signExtend<32, i64>((util::signExtend<12, i32>(i.getImmediate()) + regs.x[i.rs1]) & 0xFFFF'FFFF);
                 break;
             }
+            case OPIMM32Func::SLLIW:
+            {
+                INSTR_LOG("SLLIW x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x1F);
+                if ((i.getImmediate() >> 5) != u32(ShiftFunc::Logical))
+                    this->halt("Invalid SLLIW shift function {:x}", i.getImmediate() >> 5);
+
+                regs.x[i.rd] = util::signExtend<32, i64>(u32(regs.x[i.rs1]) << (i.getImmediate() & 0x1F));
+                break;
+            }
+            case OPIMM32Func::SRLIW_SRAIW:
+            {
+                if ((i.getImmediate() >> 5) == u32(ShiftFunc::Logical)) {
+                    INSTR_LOG("SRLIW x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x1F);
+                    regs.x[i.rd] = util::signExtend<32, i64>(u32(regs.x[i.rs1]) >> (i.getImmediate() & 0x1F));
+                } else if ((i.getImmediate() >> 5) == u32(ShiftFunc::Arithmetic) << 1) {
+                    INSTR_LOG("SRAIW x{}, x{}, #{}", i.rd, i.rs1, i.getImmediate() & 0x1F);
+                    regs.x[i.rd] = i64(i32(regs.x[i.rs1]) >> (i.getImmediate() & 0x1F));
+                } else {
+                    this->halt("Invalid word right shift function {:x}", i.getImmediate() >> 5);
+                }
+                break;
+            }
             default: this->halt("Invalid OPIMM32 function {:x}", instr.getFunction3());
         }
     }
 
     constexpr void Core::executeBRANCHInstruction(const Instruction &instr) {
         const auto &i = instr.Immediate.B;
+        const u64 rs1 = regs.x[i.rs1], rs2 = regs.x[i.rs2];
+        const u64 target = regs.pc + util::signExtend<12, i64>(i.getImmediate()) * 2;
 
+        bool taken = false;
         switch (static_cast<BRANCHFunc>(instr.getFunction3())) {
             case BRANCHFunc::BEQ:
             {
-                INSTR_LOG("BEQ x{}, x{}, #{:#x}", i.rs1, i.rs2, regs.pc + (util::signExtend<20, i64>(i.getImmediate()) * 2));
-                if (regs.x[i.rs1] == regs.x[i.rs2]) {
-                    this->nextPC = regs.pc + util::signExtend<20, i64>(i.getImmediate()) * 2;
-                }
-
+                INSTR_LOG("BEQ x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = rs1 == rs2;
                 break;
             }
             case BRANCHFunc::BNE:
             {
-                INSTR_LOG("BNE x{}, x{}, #{:#x}", i.rs1, i.rs2, regs.pc + (util::signExtend<20, i64>(i.getImmediate()) * 2));
-                if (regs.x[i.rs1] != regs.x[i.rs2]) {
-                    this->nextPC = regs.pc + util::signExtend<20, i64>(i.getImmediate()) * 2;
-                }
-
+                INSTR_LOG("BNE x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = rs1 != rs2;
+                break;
+            }
+            case BRANCHFunc::BLT:
+            {
+                INSTR_LOG("BLT x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = i64(rs1) < i64(rs2);
+                break;
+            }
+            case BRANCHFunc::BGE:
+            {
+                INSTR_LOG("BGE x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = i64(rs1) >= i64(rs2);
+                break;
+            }
+            case BRANCHFunc::BLTU:
+            {
+                INSTR_LOG("BLTU x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = rs1 < rs2;
+                break;
+            }
+            case BRANCHFunc::BGEU:
+            {
+                INSTR_LOG("BGEU x{}, x{}, #{:#x}", i.rs1, i.rs2, target);
+                taken = rs1 >= rs2;
                 break;
             }
             default: this->halt("Invalid BRANCH function {:x}", instr.getFunction3());
         }
+
+        if (taken)
+            this->nextPC = target;
     }
 
     constexpr void Core::executeLOADInstruction(const Instruction &instr) {
         const auto &i = instr.Base.I;
+        const u64 address = regs.x[i.rs1] + util::signExtend<12, i64>(i.getImmediate());
 
         switch (static_cast<LOADFunc>(instr.getFunction3())) {
             case LOADFunc::LB:
             {
                 INSTR_LOG("LB x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                regs.x[i.rd] = addressSpace(regs.x[i.rs1] + util::signExtend<12, i32>(i.getImmediate()), byte_tag{});
+                regs.x[i.rd] = util::signExtend<8, i64>(addressSpace.read(address, byte_tag{}, &this->skippedWatchpoint));
+                break;
+            }
+            case LOADFunc::LH:
+            {
+                INSTR_LOG("LH x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
+                regs.x[i.rd] = util::signExtend<16, i64>(addressSpace.read(address, hword_tag{}, &this->skippedWatchpoint));
+                break;
+            }
+            case LOADFunc::LW:
+            {
+                INSTR_LOG("LW x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
+                regs.x[i.rd] = util::signExtend<32, i64>(addressSpace.read(address, word_tag{}, &this->skippedWatchpoint));
                 break;
             }
             case LOADFunc::LD:
             {
                 INSTR_LOG("LD x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                regs.x[i.rd] = addressSpace(regs.x[i.rs1] + util::signExtend<12, i32>(i.getImmediate()), dword_tag{});
+                regs.x[i.rd] = addressSpace.read(address, dword_tag{}, &this->skippedWatchpoint);
                 break;
             }
             case LOADFunc::LBU:
             {
-                INSTR_LOG("LBU x{}, #{:#x}(x{})", i.rd, i.getImmediate(), i.rs1);
-                regs.x[i.rd] = addressSpace(regs.x[i.rs1] + i.getImmediate(), byte_tag{});
+                INSTR_LOG("LBU x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
+                regs.x[i.rd] = addressSpace.read(address, byte_tag{}, &this->skippedWatchpoint);
+                break;
+            }
+            case LOADFunc::LHU:
+            {
+                INSTR_LOG("LHU x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
+                regs.x[i.rd] = addressSpace.read(address, hword_tag{}, &this->skippedWatchpoint);
+                break;
+            }
+            case LOADFunc::LWU:
+            {
+                INSTR_LOG("LWU x{}, #{:#x}(x{})", i.rd, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
+                regs.x[i.rd] = addressSpace.read(address, word_tag{}, &this->skippedWatchpoint);
                 break;
             }
             default: this->halt("Invalid LOAD function {:x}", instr.getFunction3());
@@ -212,25 +596,25 @@ namespace vc::dev::cpu {
             case STOREFunc::SB:
             {
                 INSTR_LOG("SB x{}, #{:#x}(x{})", i.rs2, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                addressSpace(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], byte_tag{}) = regs.x[i.rs2];
+                addressSpace.write(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], regs.x[i.rs2], byte_tag{}, &this->skippedWatchpoint);
                 break;
             }
             case STOREFunc::SH:
             {
                 INSTR_LOG("SH x{}, #{:#x}(x{})", i.rs2, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                addressSpace(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], hword_tag{}) = regs.x[i.rs2];
+                addressSpace.write(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], regs.x[i.rs2], hword_tag{}, &this->skippedWatchpoint);
                 break;
             }
             case STOREFunc::SW:
             {
                 INSTR_LOG("SW x{}, #{:#x}(x{})", i.rs2, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                addressSpace(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], word_tag{}) = regs.x[i.rs2];
+                addressSpace.write(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], regs.x[i.rs2], word_tag{}, &this->skippedWatchpoint);
                 break;
             }
             case STOREFunc::SD:
             {
                 INSTR_LOG("SD x{}, #{:#x}(x{})", i.rs2, util::signExtend<12, i32>(i.getImmediate()), i.rs1);
-                addressSpace(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], dword_tag{}) = regs.x[i.rs2];
+                addressSpace.write(util::signExtend<12, i64>(i.getImmediate()) + regs.x[i.rs1], regs.x[i.rs2], dword_tag{}, &this->skippedWatchpoint);
                 break;
             }
             default: this->halt("Invalid STORE function {:x}", instr.getFunction3());
@@ -251,7 +635,7 @@ namespace vc::dev::cpu {
             case CompressedOpcode::C2:
                 executeC2Instruction(instr);
                 break;
-            default: this->halt("Unknown compressed opcode {:x}!", instr.getOpcode());
+            default: this->halt("Unknown compressed opcode {:x}!", u8(instr.getOpcode()));
         }
     }
 
@@ -266,7 +650,35 @@ namespace vc::dev::cpu {
                     this->halt("Illegal instruction at {:#x}!", regs.pc);
 
                 expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = instr_t(i.rd + 8), .funct3 = instr_t(OPIMMFunc::ADDI), .rs1 = 2);
-                expanded.Base.I.setImmediate(i.imm / 4);
+                expanded.Base.I.setImmediate(((i.imm & 0b1) << 3) | (((i.imm >> 1) & 0b1) << 2) | (((i.imm >> 2) & 0b1111) << 6) | ((i.imm >> 6) << 4));
+                break;
+            }
+            case C0Funct::C_LW:
+            {
+                auto &i = instr.CL;
+                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::LOAD), .rd = instr_t(i.rd + 8), .funct3 = instr_t(LOADFunc::LW), .rs1 = instr_t(i.rs1 + 8));
+                expanded.Base.I.setImmediate((i.imm2 << 3) | ((i.imm1 & 0b1) << 6) | ((i.imm1 >> 1) << 2));
+                break;
+            }
+            case C0Funct::C_LD:
+            {
+                auto &i = instr.CL;
+                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::LOAD), .rd = instr_t(i.rd + 8), .funct3 = instr_t(LOADFunc::LD), .rs1 = instr_t(i.rs1 + 8));
+                expanded.Base.I.setImmediate((i.imm2 << 3) | (i.imm1 << 6));
+                break;
+            }
+            case C0Funct::C_SW:
+            {
+                auto &i = instr.CS;
+                expanded = INSTRUCTION(Base, S, .opcode = instr_t(Opcode::STORE), .funct3 = instr_t(STOREFunc::SW), .rs1 = instr_t(i.rs1 + 8), .rs2 = instr_t(i.rs2 + 8));
+                expanded.Base.S.setImmediate((i.imm2 << 3) | ((i.imm1 & 0b1) << 6) | ((i.imm1 >> 1) << 2));
+                break;
+            }
+            case C0Funct::C_SD:
+            {
+                auto &i = instr.CS;
+                expanded = INSTRUCTION(Base, S, .opcode = instr_t(Opcode::STORE), .funct3 = instr_t(STOREFunc::SD), .rs1 = instr_t(i.rs1 + 8), .rs2 = instr_t(i.rs2 + 8));
+                expanded.Base.S.setImmediate((i.imm2 << 3) | (i.imm1 << 6));
                 break;
             }
             default: this->halt("Invalid C0 function {:x}", instr.getFunction3());
@@ -302,15 +714,81 @@ namespace vc::dev::cpu {
             case C1Funct::C_LUI:
             {
                 auto &i = instr.CI;
-                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = i.rd, .funct3 = instr_t(OPIMMFunc::ADDI), .rs1 = i.rd);
-                expanded.Base.I.setImmediate(util::signExtend<9, i32>((i.imm3 << 9) | ((i.imm1 >> 1) << 7) | ((i.imm2 & 0b01) << 6) | ((i.imm1 & 0b001) << 5) | (((i.imm1 & 0b010) >> 1) << 4)));
+
+                /* Adjusting the stack pointer shares its encoding with C.LUI */
+                if (i.rd == 2) /* C.ADDI16SP */ {
+                    expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = 2, .funct3 = instr_t(OPIMMFunc::ADDI), .rs1 = 2);
+                    expanded.Base.I.setImmediate(util::signExtend<10, i32>((i.imm3 << 9) | ((i.imm1 >> 1) << 7) | ((i.imm2 & 0b01) << 6) | ((i.imm1 & 0b001) << 5) | ((i.imm2 >> 1) << 4)));
+                } else {
+                    expanded = INSTRUCTION(Base, U, .opcode = instr_t(Opcode::LUI), .rd = i.rd);
+                    expanded.Base.U.setImmediate(util::signExtend<18, i32>((i.imm3 << 17) | (i.imm2 << 15) | (i.imm1 << 12)));
+                }
                 break;
             }
-            case C1Funct::C_ANDI:
+            case C1Funct::C_ARITHMETIC:
             {
-                auto &i = instr.CI;
-                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = i.rd, .funct3 = instr_t(OPIMMFunc::ANDI), .rs1 = i.rd);
-                expanded.Base.I.setImmediate(util::signExtend<6, i32>((i.imm3 << 5) | (i.imm2 << 3) | (i.imm1)));
+                auto &i = instr.CB;
+                const instr_t rd = i.rs1 + 8;
+                const u32 immediate = ((i.offset2 >> 2) << 5) | i.offset1;
+
+                switch (static_cast<C1ArithmeticFunct>(i.offset2 & 0b11)) {
+                    case C1ArithmeticFunct::C_SRLI:
+                        expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = rd, .funct3 = instr_t(OPIMMFunc::SRLI_SRAI), .rs1 = rd);
+                        expanded.Base.I.setImmediate((u32(ShiftFunc::Logical) << 6) | immediate);
+                        break;
+                    case C1ArithmeticFunct::C_SRAI:
+                        expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = rd, .funct3 = instr_t(OPIMMFunc::SRLI_SRAI), .rs1 = rd);
+                        expanded.Base.I.setImmediate((u32(ShiftFunc::Arithmetic) << 6) | immediate);
+                        break;
+                    case C1ArithmeticFunct::C_ANDI:
+                        expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = rd, .funct3 = instr_t(OPIMMFunc::ANDI), .rs1 = rd);
+                        expanded.Base.I.setImmediate(util::signExtend<6, i32>(immediate));
+                        break;
+                    case C1ArithmeticFunct::C_REGISTER:
+                    {
+                        auto &r = instr.CA;
+
+                        /* C.SUB, C.XOR, C.OR, C.AND and the word variants C.SUBW, C.ADDW */
+                        constexpr std::array<std::pair<OPFunc3, OPFunc7>, 4> Functions = {{
+                            { OPFunc3::SUB, OPFunc7::SUB }, { OPFunc3::XOR, OPFunc7::XOR }, { OPFunc3::OR, OPFunc7::OR }, { OPFunc3::AND, OPFunc7::AND }
+                        }};
+                        constexpr std::array<std::pair<OP32Func3, OP32Func7>, 2> WordFunctions = {{
+                            { OP32Func3::SUBW, OP32Func7::SUBW }, { OP32Func3::ADDW, OP32Func7::ADDW }
+                        }};
+
+                        if ((r.funct6 & 0b100) == 0) {
+                            const auto [funct3, funct7] = Functions[r.funct2];
+                            expanded = INSTRUCTION(Base, R, .opcode = instr_t(Opcode::OP), .rd = instr_t(r.rd + 8), .funct3 = instr_t(funct3), .rs1 = instr_t(r.rd + 8), .rs2 = instr_t(r.rs2 + 8), .funct7 = instr_t(funct7));
+                        } else if (r.funct2 < WordFunctions.size()) {
+                            const auto [funct3, funct7] = WordFunctions[r.funct2];
+                            expanded = INSTRUCTION(Base, R, .opcode = instr_t(Opcode::OP_32), .rd = instr_t(r.rd + 8), .funct3 = instr_t(funct3), .rs1 = instr_t(r.rd + 8), .rs2 = instr_t(r.rs2 + 8), .funct7 = instr_t(funct7));
+                        } else {
+                            this->halt("Invalid C1 register function {:x}", r.funct2);
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+            case C1Funct::C_J:
+            {
+                auto &i = instr.CJ;
+                const u32 offset = ((i.target & 0b1) << 5) | (((i.target >> 1) & 0b111) << 1) | (((i.target >> 4) & 0b1) << 7) | (((i.target >> 5) & 0b1) << 6) |
+                                   (((i.target >> 6) & 0b1) << 10) | (((i.target >> 7) & 0b11) << 8) | (((i.target >> 9) & 0b1) << 4) | ((i.target >> 10) << 11);
+
+                expanded = INSTRUCTION(Immediate, J, .opcode = instr_t(Opcode::JAL), .rd = 0);
+                expanded.Immediate.J.setImmediate(util::signExtend<12, i32>(offset) >> 1);
+                break;
+            }
+            case C1Funct::C_BEQZ:
+            case C1Funct::C_BNEZ:
+            {
+                auto &i = instr.CB;
+                const u32 offset = ((i.offset1 & 0b1) << 5) | (((i.offset1 >> 1) & 0b11) << 1) | ((i.offset1 >> 3) << 6) | ((i.offset2 & 0b11) << 3) | ((i.offset2 >> 2) << 8);
+                const auto funct3 = static_cast<C1Funct>(instr.getFunction3()) == C1Funct::C_BEQZ ? BRANCHFunc::BEQ : BRANCHFunc::BNE;
+
+                expanded = INSTRUCTION(Immediate, B, .opcode = instr_t(Opcode::BRANCH), .funct3 = instr_t(funct3), .rs1 = instr_t(i.rs1 + 8), .rs2 = 0);
+                expanded.Immediate.B.setImmediate(util::signExtend<9, i32>(offset) >> 1);
                 break;
             }
             default: this->halt("Invalid C1 function {:x}", instr.getFunction3());
@@ -321,22 +799,43 @@ namespace vc::dev::cpu {
     constexpr void Core::executeC2Instruction(const CompressedInstruction &instr) {
         Instruction expanded = { 0 };
         switch (static_cast<C2Funct>(instr.getFunction3())) {
+            case C2Funct::C_SLLI:
+            {
+                auto &i = instr.CI;
+                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::OP_IMM), .rd = i.rd, .funct3 = instr_t(OPIMMFunc::SLLI), .rs1 = i.rd);
+                expanded.Base.I.setImmediate((i.imm3 << 5) | (i.imm2 << 3) | i.imm1);
+                break;
+            }
             case C2Funct::C_JUMP:
             {
                 auto &i = instr.CR;
 
                 if (i.rd != 0 && i.funct4 == 0b1000 && i.rs2 != 0) /* C.MV */ {
-                    expanded = INSTRUCTION(Base, R, .opcode = instr_t(Opcode::LOAD), .rd = i.rd, .funct3 = instr_t(OPFunc3::ADD), .rs1 = 0, .rs2 = i.rs2, .funct7 = instr_t(OPFunc7::ADD));
+                    expanded = INSTRUCTION(Base, R, .opcode = instr_t(Opcode::OP), .rd = i.rd, .funct3 = instr_t(OPFunc3::ADD), .rs1 = 0, .rs2 = i.rs2, .funct7 = instr_t(OPFunc7::ADD));
                 } else if (i.rd != 0 && i.funct4 == 0b1000 && i.rs2 == 0) /* C.JR */ {
                     INSTR_LOG("C.JR x{}, x{}, #{:#x}", 0, i.rd, 0);
                     this->nextPC = regs.x[i.rd];
+
+                    if (this->profile != nullptr && !this->replaying) [[unlikely]]
+                        this->profile->jump(regs.pc, 0, i.rd);
                     return;
+                } else if (i.rd != 0 && i.funct4 == 0b1001 && i.rs2 != 0) /* C.ADD */ {
+                    expanded = INSTRUCTION(Base, R, .opcode = instr_t(Opcode::OP), .rd = i.rd, .funct3 = instr_t(OPFunc3::ADD), .rs1 = i.rd, .rs2 = i.rs2, .funct7 = instr_t(OPFunc7::ADD));
+                } else if (i.rd != 0 && i.funct4 == 0b1001 && i.rs2 == 0) /* C.JALR */ {
+                    expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::JALR), .rd = 1, .funct3 = 0b000, .rs1 = i.rd);
                 } else {
                     this->halt("Invalid C2 C_JUMP function {:x}", instr.getFunction4());
                 }
 
                 break;
             }
+            case C2Funct::C_LWSP:
+            {
+                auto &i = instr.CI;
+                expanded = INSTRUCTION(Base, I, .opcode = instr_t(Opcode::LOAD), .rd = i.rd, .funct3 = instr_t(LOADFunc::LW), .rs1 = 2);
+                expanded.Base.I.setImmediate(((i.imm1 & 0b11) << 6) | ((i.imm1 >> 2) << 2) | (i.imm3 << 5) | (i.imm2 << 3));
+                break;
+            }
             case C2Funct::C_LDSP:
             {
                 auto &i = instr.CI;
@@ -344,11 +843,18 @@ namespace vc::dev::cpu {
                 expanded.Base.I.setImmediate((i.imm1 << 6) | (i.imm3 << 5) | (i.imm2 << 3));
                 break;
             }
+            case C2Funct::C_SWSP:
+            {
+                auto &i = instr.CSS;
+                expanded = INSTRUCTION(Base, S, .opcode = instr_t(Opcode::STORE), .funct3 = instr_t(STOREFunc::SW), .rs1 = 2, .rs2 = i.rs2);
+                expanded.Base.S.setImmediate(((i.imm & 0b11) << 6) | (i.imm & 0b111100));
+                break;
+            }
             case C2Funct::C_SDSP:
             {
                 auto &i = instr.CSS;
                 expanded = INSTRUCTION(Base, S, .opcode = instr_t(Opcode::STORE), .funct3 = instr_t(STOREFunc::SD), .rs1 = 2, .rs2 = i.rs2);
-                expanded.Base.S.setImmediate(i.imm);
+                expanded.Base.S.setImmediate(((i.imm & 0b111) << 6) | (i.imm & 0b111000));
                 break;
             }
             default: this->halt("Invalid C2 function {:x}", instr.getFunction3());
@@ -357,4 +863,4 @@ namespace vc::dev::cpu {
         executeInstruction(expanded);
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,543 @@
+#include <devices/cpu/core/disassembler.hpp>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace vc::dev::cpu {
+
+    namespace {
+
+        constexpr std::array<std::string_view, 32> IntegerRegisters = {
+            "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+            "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+            "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+            "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+        };
+
+        constexpr std::array<std::string_view, 32> FloatRegisters = {
+            "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
+            "fs0", "fs1", "fa0", "fa1", "fa2", "fa3", "fa4", "fa5",
+            "fa6", "fa7", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7",
+            "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11"
+        };
+
+        constexpr std::array<std::string_view, 8> RoundingModes = { "rne", "rtz", "rdn", "rup", "rmm", "", "", "dyn" };
+
+        [[nodiscard]]
+        constexpr u32 bits(u32 value, u8 from, u8 count) {
+            return (value >> from) & ((u32(1) << count) - 1);
+        }
+
+        [[nodiscard]]
+        constexpr i64 signExtend(u64 value, u8 width) {
+            const auto shift = 64 - width;
+            return i64(value << shift) >> shift;
+        }
+
+        [[nodiscard]]
+        std::string_view x(u32 reg) { return IntegerRegisters[reg & 0b11111]; }
+
+        [[nodiscard]]
+        std::string_view f(u32 reg) { return FloatRegisters[reg & 0b11111]; }
+
+        /* Registers x8 - x15 as encoded in the three bit register fields of compressed instructions */
+        [[nodiscard]]
+        std::string_view xc(u32 reg) { return IntegerRegisters[8 + (reg & 0b111)]; }
+
+        [[nodiscard]]
+        std::string_view fc(u32 reg) { return FloatRegisters[8 + (reg & 0b111)]; }
+
+        [[nodiscard]]
+        DisassembledInstruction make(u8 size, std::string_view mnemonic, std::string operands = "", std::optional<u64> target = { }) {
+            return { size, std::string(mnemonic), std::move(operands), target };
+        }
+
+        [[nodiscard]]
+        DisassembledInstruction invalid(u8 size) {
+            return make(size, "unknown");
+        }
+
+        [[nodiscard]]
+        std::string_view csrName(u32 csr) {
+            switch (csr) {
+                case 0x001: return "fflags";
+                case 0x002: return "frm";
+                case 0x003: return "fcsr";
+                case 0xC00: return "cycle";
+                case 0xC01: return "time";
+                case 0xC02: return "instret";
+                case 0x100: return "sstatus";
+                case 0x104: return "sie";
+                case 0x105: return "stvec";
+                case 0x140: return "sscratch";
+                case 0x141: return "sepc";
+                case 0x142: return "scause";
+                case 0x143: return "stval";
+                case 0x144: return "sip";
+                case 0x180: return "satp";
+                case 0x300: return "mstatus";
+                case 0x301: return "misa";
+                case 0x302: return "medeleg";
+                case 0x303: return "mideleg";
+                case 0x304: return "mie";
+                case 0x305: return "mtvec";
+                case 0x340: return "mscratch";
+                case 0x341: return "mepc";
+                case 0x342: return "mcause";
+                case 0x343: return "mtval";
+                case 0x344: return "mip";
+                case 0xF11: return "mvendorid";
+                case 0xF12: return "marchid";
+                case 0xF13: return "mimpid";
+                case 0xF14: return "mhartid";
+                default:    return "";
+            }
+        }
+
+        [[nodiscard]]
+        std::string csr(u32 csr) {
+            auto name = csrName(csr);
+            return name.empty() ? fmt::format("{:#x}", csr) : std::string(name);
+        }
+
+        DisassembledInstruction disassembleOP(const Instruction &instr) {
+            const auto &i = instr.Base.R;
+            const auto operands = fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), x(i.rs2));
+
+            constexpr static std::array<std::string_view, 8> Base = { "add", "sll", "slt", "sltu", "xor", "srl", "or", "and" };
+            constexpr static std::array<std::string_view, 8> Multiply = { "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu" };
+
+            switch (i.funct7) {
+                case 0b0000000: return make(4, Base[i.funct3], operands);
+                case 0b0000001: return make(4, Multiply[i.funct3], operands);
+                case 0b0100000:
+                    if (i.funct3 == 0b000) return make(4, "sub", operands);
+                    if (i.funct3 == 0b101) return make(4, "sra", operands);
+                    break;
+            }
+
+            return invalid(4);
+        }
+
+        DisassembledInstruction disassembleOP32(const Instruction &instr) {
+            const auto &i = instr.Base.R;
+            const auto operands = fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), x(i.rs2));
+
+            switch (i.funct7) {
+                case 0b0000000:
+                    if (i.funct3 == 0b000) return make(4, "addw", operands);
+                    if (i.funct3 == 0b001) return make(4, "sllw", operands);
+                    if (i.funct3 == 0b101) return make(4, "srlw", operands);
+                    break;
+                case 0b0100000:
+                    if (i.funct3 == 0b000) return make(4, "subw", operands);
+                    if (i.funct3 == 0b101) return make(4, "sraw", operands);
+                    break;
+                case 0b0000001:
+                {
+                    constexpr static std::array<std::string_view, 8> Multiply = { "mulw", "", "", "", "divw", "divuw", "remw", "remuw" };
+                    if (!Multiply[i.funct3].empty()) return make(4, Multiply[i.funct3], operands);
+                    break;
+                }
+            }
+
+            return invalid(4);
+        }
+
+        DisassembledInstruction disassembleOPIMM(const Instruction &instr, bool word) {
+            const auto &i = instr.Base.I;
+            const auto immediate = signExtend(i.getImmediate(), 12);
+            const auto shamt = word ? bits(i.getImmediate(), 0, 5) : bits(i.getImmediate(), 0, 6);
+            const auto suffix = word ? "w" : "";
+
+            switch (i.funct3) {
+                case 0b000:
+                    if (!word && i.rd == 0 && i.rs1 == 0 && immediate == 0) return make(4, "nop");
+                    if (!word && i.rs1 == 0) return make(4, "li", fmt::format("{}, {}", x(i.rd), immediate));
+                    if (!word && immediate == 0) return make(4, "mv", fmt::format("{}, {}", x(i.rd), x(i.rs1)));
+                    if (word && immediate == 0) return make(4, "sext.w", fmt::format("{}, {}", x(i.rd), x(i.rs1)));
+                    return make(4, fmt::format("addi{}", suffix), fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), immediate));
+                case 0b001:
+                    return make(4, fmt::format("slli{}", suffix), fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), shamt));
+                case 0b101:
+                    return make(4, fmt::format("{}{}", bits(i.getImmediate(), 10, 1) ? "srai" : "srli", suffix), fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), shamt));
+            }
+
+            if (word)
+                return invalid(4);
+
+            constexpr static std::array<std::string_view, 8> Names = { "", "", "slti", "sltiu", "xori", "", "ori", "andi" };
+            return make(4, Names[i.funct3], fmt::format("{}, {}, {}", x(i.rd), x(i.rs1), immediate));
+        }
+
+        DisassembledInstruction disassembleAMO(const Instruction &instr) {
+            const auto &i = instr.Base.R;
+            const auto funct5 = i.funct7 >> 2;
+            const auto width = i.funct3 == 0b010 ? ".w" : i.funct3 == 0b011 ? ".d" : nullptr;
+            if (width == nullptr) return invalid(4);
+
+            constexpr static std::array<std::string_view, 4> Orderings = { "", ".rl", ".aq", ".aqrl" };
+            const auto ordering = Orderings[i.funct7 & 0b11];
+
+            switch (funct5) {
+                case 0b00010: return make(4, fmt::format("lr{}{}", width, ordering), fmt::format("{}, ({})", x(i.rd), x(i.rs1)));
+                case 0b00011: return make(4, fmt::format("sc{}{}", width, ordering), fmt::format("{}, {}, ({})", x(i.rd), x(i.rs2), x(i.rs1)));
+            }
+
+            std::string_view name;
+            switch (funct5) {
+                case 0b00001: name = "amoswap"; break;
+                case 0b00000: name = "amoadd"; break;
+                case 0b00100: name = "amoxor"; break;
+                case 0b01100: name = "amoand"; break;
+                case 0b01000: name = "amoor"; break;
+                case 0b10000: name = "amomin"; break;
+                case 0b10100: name = "amomax"; break;
+                case 0b11000: name = "amominu"; break;
+                case 0b11100: name = "amomaxu"; break;
+                default: return invalid(4);
+            }
+
+            return make(4, fmt::format("{}{}{}", name, width, ordering), fmt::format("{}, {}, ({})", x(i.rd), x(i.rs2), x(i.rs1)));
+        }
+
+        DisassembledInstruction disassembleSYSTEM(u32 raw, const Instruction &instr) {
+            const auto &i = instr.Base.I;
+
+            if (i.funct3 == 0b000) {
+                switch (raw) {
+                    case 0x00000073: return make(4, "ecall");
+                    case 0x00100073: return make(4, "ebreak");
+                    case 0x10200073: return make(4, "sret");
+                    case 0x30200073: return make(4, "mret");
+                    case 0x10500073: return make(4, "wfi");
+                }
+
+                if (instr.Base.R.funct7 == 0b0001001)
+                    return make(4, "sfence.vma", fmt::format("{}, {}", x(i.rs1), x(instr.Base.R.rs2)));
+
+                return invalid(4);
+            }
+
+            constexpr static std::array<std::string_view, 8> Names = { "", "csrrw", "csrrs", "csrrc", "", "csrrwi", "csrrsi", "csrrci" };
+            if (Names[i.funct3].empty()) return invalid(4);
+
+            const auto source = i.funct3 & 0b100 ? fmt::format("{}", u32(i.rs1)) : std::string(x(i.rs1));
+            if (i.funct3 == 0b010 && i.rs1 == 0)
+                return make(4, "csrr", fmt::format("{}, {}", x(i.rd), csr(i.getImmediate())));
+
+            return make(4, Names[i.funct3], fmt::format("{}, {}, {}", x(i.rd), csr(i.getImmediate()), source));
+        }
+
+        DisassembledInstruction disassembleOPFP(const Instruction &instr) {
+            const auto &i = instr.Base.R;
+            const auto format = (i.funct7 & 0b11) == 0 ? "s" : (i.funct7 & 0b11) == 1 ? "d" : nullptr;
+            if (format == nullptr) return invalid(4);
+
+            const auto roundingMode = RoundingModes[i.funct3];
+            const auto withRounding = [&](std::string operands) {
+                return i.funct3 == 0b111 || roundingMode.empty() ? operands : fmt::format("{}, {}", operands, roundingMode);
+            };
+
+            switch (i.funct7 >> 2) {
+                case 0b00000: return make(4, fmt::format("fadd.{}", format), withRounding(fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2))));
+                case 0b00001: return make(4, fmt::format("fsub.{}", format), withRounding(fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2))));
+                case 0b00010: return make(4, fmt::format("fmul.{}", format), withRounding(fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2))));
+                case 0b00011: return make(4, fmt::format("fdiv.{}", format), withRounding(fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2))));
+                case 0b01011: return make(4, fmt::format("fsqrt.{}", format), withRounding(fmt::format("{}, {}", f(i.rd), f(i.rs1))));
+                case 0b00100:
+                {
+                    constexpr static std::array<std::string_view, 3> Names = { "fsgnj", "fsgnjn", "fsgnjx" };
+                    if (i.funct3 > 2) return invalid(4);
+                    return make(4, fmt::format("{}.{}", Names[i.funct3], format), fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2)));
+                }
+                case 0b00101:
+                    if (i.funct3 > 1) return invalid(4);
+                    return make(4, fmt::format("{}.{}", i.funct3 == 0 ? "fmin" : "fmax", format), fmt::format("{}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2)));
+                case 0b01000:
+                    return make(4, fmt::format("fcvt.{}.{}", format, i.rs2 == 0 ? "s" : "d"), withRounding(fmt::format("{}, {}", f(i.rd), f(i.rs1))));
+                case 0b10100:
+                {
+                    constexpr static std::array<std::string_view, 3> Names = { "fle", "flt", "feq" };
+                    if (i.funct3 > 2) return invalid(4);
+                    return make(4, fmt::format("{}.{}", Names[i.funct3], format), fmt::format("{}, {}, {}", x(i.rd), f(i.rs1), f(i.rs2)));
+                }
+                case 0b11000:
+                {
+                    constexpr static std::array<std::string_view, 4> Types = { "w", "wu", "l", "lu" };
+                    if (i.rs2 > 3) return invalid(4);
+                    return make(4, fmt::format("fcvt.{}.{}", Types[i.rs2], format), withRounding(fmt::format("{}, {}", x(i.rd), f(i.rs1))));
+                }
+                case 0b11010:
+                {
+                    constexpr static std::array<std::string_view, 4> Types = { "w", "wu", "l", "lu" };
+                    if (i.rs2 > 3) return invalid(4);
+                    return make(4, fmt::format("fcvt.{}.{}", format, Types[i.rs2]), withRounding(fmt::format("{}, {}", f(i.rd), x(i.rs1))));
+                }
+                case 0b11100:
+                    if (i.funct3 == 0b000) return make(4, fmt::format("fmv.x.{}", format[0] == 's' ? "w" : "d"), fmt::format("{}, {}", x(i.rd), f(i.rs1)));
+                    if (i.funct3 == 0b001) return make(4, fmt::format("fclass.{}", format), fmt::format("{}, {}", x(i.rd), f(i.rs1)));
+                    break;
+                case 0b11110:
+                    if (i.funct3 == 0b000) return make(4, fmt::format("fmv.{}.x", format[0] == 's' ? "w" : "d"), fmt::format("{}, {}", f(i.rd), x(i.rs1)));
+                    break;
+            }
+
+            return invalid(4);
+        }
+
+        DisassembledInstruction disassembleRegular(u32 raw, u64 address) {
+            Instruction instr;
+            static_assert(sizeof(instr) == sizeof(raw));
+            std::memcpy(&instr, &raw, sizeof(raw));
+
+            switch (instr.getOpcode()) {
+                case Opcode::LUI:
+                    return make(4, "lui", fmt::format("{}, {:#x}", x(instr.Base.U.rd), u32(instr.Base.U.imm12_31)));
+                case Opcode::AUIPC:
+                    return make(4, "auipc", fmt::format("{}, {:#x}", x(instr.Base.U.rd), u32(instr.Base.U.imm12_31)));
+                case Opcode::JAL:
+                {
+                    const auto &i = instr.Immediate.J;
+                    const u64 target = address + signExtend(u64(i.getImmediate()) * 2, 21);
+
+                    if (i.rd == 0) return make(4, "j", fmt::format("{:#x}", target), target);
+                    return make(4, "jal", i.rd == 1 ? fmt::format("{:#x}", target) : fmt::format("{}, {:#x}", x(i.rd), target), target);
+                }
+                case Opcode::JALR:
+                {
+                    const auto &i = instr.Base.I;
+                    const auto offset = signExtend(i.getImmediate(), 12);
+
+                    if (i.rd == 0 && i.rs1 == 1 && offset == 0) return make(4, "ret");
+                    if (i.rd == 0 && offset == 0) return make(4, "jr", std::string(x(i.rs1)));
+                    return make(4, "jalr", fmt::format("{}, {}({})", x(i.rd), offset, x(i.rs1)));
+                }
+                case Opcode::BRANCH:
+                {
+                    const auto &i = instr.Immediate.B;
+                    const u64 target = address + signExtend(u64(i.getImmediate()) * 2, 13);
+
+                    constexpr static std::array<std::string_view, 8> Names = { "beq", "bne", "", "", "blt", "bge", "bltu", "bgeu" };
+                    if (Names[i.funct3].empty()) return invalid(4);
+
+                    if (i.rs2 == 0 && (i.funct3 == 0b000 || i.funct3 == 0b001))
+                        return make(4, fmt::format("{}z", Names[i.funct3]), fmt::format("{}, {:#x}", x(i.rs1), target), target);
+
+                    return make(4, Names[i.funct3], fmt::format("{}, {}, {:#x}", x(i.rs1), x(i.rs2), target), target);
+                }
+                case Opcode::LOAD:
+                {
+                    const auto &i = instr.Base.I;
+
+                    constexpr static std::array<std::string_view, 8> Names = { "lb", "lh", "lw", "ld", "lbu", "lhu", "lwu", "" };
+                    if (Names[i.funct3].empty()) return invalid(4);
+
+                    return make(4, Names[i.funct3], fmt::format("{}, {}({})", x(i.rd), signExtend(i.getImmediate(), 12), x(i.rs1)));
+                }
+                case Opcode::STORE:
+                {
+                    const auto &i = instr.Base.S;
+
+                    constexpr static std::array<std::string_view, 8> Names = { "sb", "sh", "sw", "sd", "", "", "", "" };
+                    if (Names[i.funct3].empty()) return invalid(4);
+
+                    return make(4, Names[i.funct3], fmt::format("{}, {}({})", x(i.rs2), signExtend(i.getImmediate(), 12), x(i.rs1)));
+                }
+                case Opcode::LOAD_FP:
+                {
+                    const auto &i = instr.Base.I;
+                    if (i.funct3 != 0b010 && i.funct3 != 0b011) return invalid(4);
+
+                    return make(4, i.funct3 == 0b010 ? "flw" : "fld", fmt::format("{}, {}({})", f(i.rd), signExtend(i.getImmediate(), 12), x(i.rs1)));
+                }
+                case Opcode::STORE_FP:
+                {
+                    const auto &i = instr.Base.S;
+                    if (i.funct3 != 0b010 && i.funct3 != 0b011) return invalid(4);
+
+                    return make(4, i.funct3 == 0b010 ? "fsw" : "fsd", fmt::format("{}, {}({})", f(i.rs2), signExtend(i.getImmediate(), 12), x(i.rs1)));
+                }
+                case Opcode::OP_IMM:
+                    return disassembleOPIMM(instr, false);
+                case Opcode::OP_IMM32:
+                    return disassembleOPIMM(instr, true);
+                case Opcode::OP:
+                    return disassembleOP(instr);
+                case Opcode::OP_32:
+                    return disassembleOP32(instr);
+                case Opcode::AMO:
+                    return disassembleAMO(instr);
+                case Opcode::MISC_MEM:
+                    if (instr.getFunction3() == 0b001) return make(4, "fence.i");
+                    if (instr.getFunction3() == 0b000) return make(4, "fence");
+                    return invalid(4);
+                case Opcode::SYSTEM:
+                    return disassembleSYSTEM(raw, instr);
+                case Opcode::FMADD:
+                case Opcode::FMSUB:
+                case Opcode::FNMSUB:
+                case Opcode::FNMADD:
+                {
+                    const auto &i = instr.Base.R;
+                    const auto format = (i.funct7 & 0b11) == 0 ? "s" : (i.funct7 & 0b11) == 1 ? "d" : nullptr;
+                    if (format == nullptr) return invalid(4);
+
+                    const auto name = instr.getOpcode() == Opcode::FMADD ? "fmadd" : instr.getOpcode() == Opcode::FMSUB ? "fmsub" : instr.getOpcode() == Opcode::FNMSUB ? "fnmsub" : "fnmadd";
+                    return make(4, fmt::format("{}.{}", name, format), fmt::format("{}, {}, {}, {}", f(i.rd), f(i.rs1), f(i.rs2), f(i.funct7 >> 2)));
+                }
+                case Opcode::OP_FP:
+                    return disassembleOPFP(instr);
+            }
+
+            return invalid(4);
+        }
+
+        DisassembledInstruction disassembleC0(u16 raw) {
+            const auto rdp = bits(raw, 2, 3), rs1p = bits(raw, 7, 3);
+            const auto offsetW = (bits(raw, 10, 3) << 3) | (bits(raw, 6, 1) << 2) | (bits(raw, 5, 1) << 6);
+            const auto offsetD = (bits(raw, 10, 3) << 3) | (bits(raw, 5, 2) << 6);
+
+            switch (bits(raw, 13, 3)) {
+                case 0b000:
+                {
+                    const auto immediate = (bits(raw, 11, 2) << 4) | (bits(raw, 7, 4) << 6) | (bits(raw, 6, 1) << 2) | (bits(raw, 5, 1) << 3);
+                    if (immediate == 0) return invalid(2);
+                    return make(2, "c.addi4spn", fmt::format("{}, sp, {}", xc(rdp), immediate));
+                }
+                case 0b001: return make(2, "c.fld", fmt::format("{}, {}({})", fc(rdp), offsetD, xc(rs1p)));
+                case 0b010: return make(2, "c.lw", fmt::format("{}, {}({})", xc(rdp), offsetW, xc(rs1p)));
+                case 0b011: return make(2, "c.ld", fmt::format("{}, {}({})", xc(rdp), offsetD, xc(rs1p)));
+                case 0b101: return make(2, "c.fsd", fmt::format("{}, {}({})", fc(rdp), offsetD, xc(rs1p)));
+                case 0b110: return make(2, "c.sw", fmt::format("{}, {}({})", xc(rdp), offsetW, xc(rs1p)));
+                case 0b111: return make(2, "c.sd", fmt::format("{}, {}({})", xc(rdp), offsetD, xc(rs1p)));
+            }
+
+            return invalid(2);
+        }
+
+        DisassembledInstruction disassembleC1(u16 raw, u64 address) {
+            const auto rd = bits(raw, 7, 5);
+            const auto immediate = signExtend((bits(raw, 12, 1) << 5) | bits(raw, 2, 5), 6);
+
+            const auto jumpTarget = [&]() -> u64 {
+                const auto offset = (bits(raw, 12, 1) << 11) | (bits(raw, 11, 1) << 4) | (bits(raw, 9, 2) << 8) | (bits(raw, 8, 1) << 10) |
+                                    (bits(raw, 7, 1) << 6) | (bits(raw, 6, 1) << 7) | (bits(raw, 3, 3) << 1) | (bits(raw, 2, 1) << 5);
+                return address + signExtend(offset, 12);
+            };
+
+            const auto branchTarget = [&]() -> u64 {
+                const auto offset = (bits(raw, 12, 1) << 8) | (bits(raw, 10, 2) << 3) | (bits(raw, 5, 2) << 6) | (bits(raw, 3, 2) << 1) | (bits(raw, 2, 1) << 5);
+                return address + signExtend(offset, 9);
+            };
+
+            switch (bits(raw, 13, 3)) {
+                case 0b000:
+                    if (rd == 0) return make(2, "c.nop");
+                    return make(2, "c.addi", fmt::format("{}, {}", x(rd), immediate));
+                case 0b001:
+                    if (rd == 0) return invalid(2);
+                    return make(2, "c.addiw", fmt::format("{}, {}", x(rd), immediate));
+                case 0b010:
+                    return make(2, "c.li", fmt::format("{}, {}", x(rd), immediate));
+                case 0b011:
+                    if (rd == 2) {
+                        const auto offset = (bits(raw, 12, 1) << 9) | (bits(raw, 6, 1) << 4) | (bits(raw, 5, 1) << 6) | (bits(raw, 3, 2) << 7) | (bits(raw, 2, 1) << 5);
+                        if (offset == 0) return invalid(2);
+                        return make(2, "c.addi16sp", fmt::format("sp, {}", signExtend(offset, 10)));
+                    }
+                    if (immediate == 0) return invalid(2);
+                    return make(2, "c.lui", fmt::format("{}, {:#x}", x(rd), u32(immediate) & 0xFFFFF));
+                case 0b100:
+                {
+                    const auto rdp = bits(raw, 7, 3), rs2p = bits(raw, 2, 3);
+                    const auto shamt = (bits(raw, 12, 1) << 5) | bits(raw, 2, 5);
+
+                    switch (bits(raw, 10, 2)) {
+                        case 0b00: return make(2, "c.srli", fmt::format("{}, {}", xc(rdp), shamt));
+                        case 0b01: return make(2, "c.srai", fmt::format("{}, {}", xc(rdp), shamt));
+                        case 0b10: return make(2, "c.andi", fmt::format("{}, {}", xc(rdp), immediate));
+                        case 0b11:
+                        {
+                            constexpr static std::array<std::string_view, 8> Names = { "c.sub", "c.xor", "c.or", "c.and", "c.subw", "c.addw", "", "" };
+                            const auto name = Names[(bits(raw, 12, 1) << 2) | bits(raw, 5, 2)];
+                            if (name.empty()) return invalid(2);
+
+                            return make(2, name, fmt::format("{}, {}", xc(rdp), xc(rs2p)));
+                        }
+                    }
+                    break;
+                }
+                case 0b101:
+                {
+                    const auto target = jumpTarget();
+                    return make(2, "c.j", fmt::format("{:#x}", target), target);
+                }
+                case 0b110:
+                case 0b111:
+                {
+                    const auto target = branchTarget();
+                    return make(2, bits(raw, 13, 3) == 0b110 ? "c.beqz" : "c.bnez", fmt::format("{}, {:#x}", xc(bits(raw, 7, 3)), target), target);
+                }
+            }
+
+            return invalid(2);
+        }
+
+        DisassembledInstruction disassembleC2(u16 raw) {
+            const auto rd = bits(raw, 7, 5), rs2 = bits(raw, 2, 5);
+
+            switch (bits(raw, 13, 3)) {
+                case 0b000:
+                    return make(2, "c.slli", fmt::format("{}, {}", x(rd), (bits(raw, 12, 1) << 5) | bits(raw, 2, 5)));
+                case 0b001:
+                    return make(2, "c.fldsp", fmt::format("{}, {}(sp)", f(rd), (bits(raw, 12, 1) << 5) | (bits(raw, 5, 2) << 3) | (bits(raw, 2, 3) << 6)));
+                case 0b010:
+                    if (rd == 0) return invalid(2);
+                    return make(2, "c.lwsp", fmt::format("{}, {}(sp)", x(rd), (bits(raw, 12, 1) << 5) | (bits(raw, 4, 3) << 2) | (bits(raw, 2, 2) << 6)));
+                case 0b011:
+                    if (rd == 0) return invalid(2);
+                    return make(2, "c.ldsp", fmt::format("{}, {}(sp)", x(rd), (bits(raw, 12, 1) << 5) | (bits(raw, 5, 2) << 3) | (bits(raw, 2, 3) << 6)));
+                case 0b100:
+                    if (bits(raw, 12, 1) == 0) {
+                        if (rs2 == 0) return rd == 0 ? invalid(2) : make(2, "c.jr", std::string(x(rd)));
+                        return make(2, "c.mv", fmt::format("{}, {}", x(rd), x(rs2)));
+                    } else {
+                        if (rd == 0 && rs2 == 0) return make(2, "c.ebreak");
+                        if (rs2 == 0) return make(2, "c.jalr", std::string(x(rd)));
+                        return make(2, "c.add", fmt::format("{}, {}", x(rd), x(rs2)));
+                    }
+                case 0b101:
+                    return make(2, "c.fsdsp", fmt::format("{}, {}(sp)", f(rs2), (bits(raw, 10, 3) << 3) | (bits(raw, 7, 3) << 6)));
+                case 0b110:
+                    return make(2, "c.swsp", fmt::format("{}, {}(sp)", x(rs2), (bits(raw, 9, 4) << 2) | (bits(raw, 7, 2) << 6)));
+                case 0b111:
+                    return make(2, "c.sdsp", fmt::format("{}, {}(sp)", x(rs2), (bits(raw, 10, 3) << 3) | (bits(raw, 7, 3) << 6)));
+            }
+
+            return invalid(2);
+        }
+
+    }
+
+    DisassembledInstruction disassemble(u32 instruction, u64 address) {
+        if (getInstructionSize(instruction) == InstructionSize)
+            return disassembleRegular(instruction, address);
+
+        const auto compressed = u16(instruction);
+        if (compressed == 0x0000)
+            return invalid(2);
+
+        switch (static_cast<CompressedOpcode>(compressed & 0b11)) {
+            case CompressedOpcode::C0: return disassembleC0(compressed);
+            case CompressedOpcode::C1: return disassembleC1(compressed, address);
+            case CompressedOpcode::C2: return disassembleC2(compressed);
+        }
+
+        return invalid(2);
+    }
+
+}
@@ -0,0 +1,321 @@
+#include <board/board_headless.hpp>
+#include <board/fleet.hpp>
+#include <board/runner.hpp>
+#include <debug/profiler.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace {
+
+    /* Exit codes of runs the guest didn't end through the test finisher */
+    constexpr int ExitUsage       = 2;
+    constexpr int ExitBudget      = 124;
+    constexpr int ExitHalted      = 125;
+
+    struct Options {
+        std::vector<std::string_view> elfPaths;
+        std::optional<std::string_view> uartPath, reportPath, profilePath, flatProfilePath;
+        std::optional<u64> maxInstructions, sliceInstructions;
+        u32 profileInterval = vc::debug::Profiler::DefaultInterval;
+        std::optional<double> timeout;
+        std::optional<u32> workers;
+        u32 copies = 1;
+    };
+
+    void printUsage(const char *name) {
+        fmt::print(stderr,
+            "Usage: {} <firmware.elf>... [options]\n"
+            "  --uart <path>              Write UART output to a file instead of stdout\n"
+            "  --max-instructions <n>     Stop after n retired instructions\n"
+            "  --timeout <seconds>        Stop after the given wall time\n"
+            "  --workers <n>              Number of simulation threads\n"
+            "  --profile <path>           Write a sampled profile of the firmware as collapsed stacks for flame graphs\n"
+            "  --profile-flat <path>      Write a sampled profile of the firmware as a flat per function table\n"
+            "  --profile-interval <n>     Instructions between two profile samples, {} by default\n"
+            "\n"
+            "Fleet mode, used as soon as more than one board gets simulated. UART output goes into the report, profiling isn't available:\n"
+            "  --copies <n>               Number of boards to run every firmware on\n"
+            "  --slice <n>                Instructions a board runs before its worker moves on\n"
+            "  --report <path>            Write the per board results as JSON\n"
+            "\n"
+            "Cycle counts the guest writes to the cycle counter's REPORT register at 0x{:08X} get logged.\n"
+            "Exits with the code the guest wrote to the test finisher at 0x{:08X},\n"
+            "{} if a budget ran out and {} if all cores halted without finishing.\n"
+            "A fleet exits with 0 if every board finished with 0 and with 1 otherwise\n",
+            name, vc::debug::Profiler::DefaultInterval, 0x0010'1008, 0x0010'0000, ExitBudget, ExitHalted);
+    }
+
+    [[nodiscard]]
+    std::string_view getReasonName(vc::pcb::StopReason reason) {
+        switch (reason) {
+            using enum vc::pcb::StopReason;
+            case InstructionLimit:  return "instruction_limit";
+            case Breakpoint:        return "breakpoint";
+            case Output:            return "output";
+            case Finished:          return "finished";
+            case Timeout:           return "timeout";
+            default:                return "halted";
+        }
+    }
+
+    [[nodiscard]]
+    std::string escapeJson(std::string_view string) {
+        std::string result;
+        for (char c : string) {
+            switch (c) {
+                case '"':   result += "\\\""; break;
+                case '\\':  result += "\\\\"; break;
+                case '\n':  result += "\\n"; break;
+                case '\r':  result += "\\r"; break;
+                case '\t':  result += "\\t"; break;
+                default:
+                    if (u8(c) < 0x20 || u8(c) >= 0x80)
+                        result += fmt::format("\\u{:04x}", u8(c));
+                    else
+                        result += c;
+            }
+        }
+
+        return result;
+    }
+
+    [[nodiscard]]
+    bool loadFirmware(vc::pcb::HeadlessBoard &board, std::string_view path) {
+        try {
+            if (!board.cpu.getAddressSpace().loadELF(path)) {
+                vc::log::error("Failed to open '{}'", path);
+                return false;
+            }
+        } catch (const vc::dev::cpu::AccessFaultException&) {
+            vc::log::error("'{}' contains sections outside of the board's memory", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]]
+    std::chrono::steady_clock::duration toDuration(double seconds) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    bool writeProfile(const vc::debug::Profiler &profiler, const vc::debug::SymbolTable &symbols, std::string_view path, bool flat) {
+        FILE *file = fopen(std::string(path).c_str(), "wb");
+        if (file == nullptr) {
+            vc::log::error("Failed to open '{}' for writing", path);
+            return false;
+        }
+
+        if (flat)
+            profiler.writeFlatProfile(file, symbols);
+        else
+            profiler.writeCollapsedStacks(file, symbols);
+
+        fclose(file);
+        return true;
+    }
+
+    int runSingle(const Options &options) {
+        vc::pcb::HeadlessBoard board;
+        if (!loadFirmware(board, options.elfPaths.front()))
+            return ExitUsage;
+
+        FILE *uartOutput = stdout;
+        if (options.uartPath.has_value()) {
+            uartOutput = fopen(std::string(*options.uartPath).c_str(), "wb");
+            if (uartOutput == nullptr) {
+                vc::log::error("Failed to open '{}' for writing", *options.uartPath);
+                return ExitUsage;
+            }
+        }
+        board.console.setOutput(uartOutput);
+
+        if (options.workers.has_value())
+            board.setWorkerCount(*options.workers);
+
+        vc::pcb::Runner runner(board);
+        runner.setCaptureOutput(false);
+        if (options.timeout.has_value())
+            runner.setTimeout(toDuration(*options.timeout));
+
+        std::optional<vc::debug::Profiler> profiler;
+        if (options.profilePath.has_value() || options.flatProfilePath.has_value())
+            profiler.emplace(board.cpu, options.profileInterval);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = runner.run(options.maxInstructions.value_or(vc::pcb::Runner::Unlimited));
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        fflush(uartOutput);
+        if (uartOutput != stdout)
+            fclose(uartOutput);
+
+        int exitCode;
+        switch (result.reason) {
+            case vc::pcb::StopReason::Finished:
+                exitCode = int(*runner.getExitCode());
+                vc::log::info("Guest finished with exit code {}", exitCode);
+                break;
+            case vc::pcb::StopReason::InstructionLimit:
+            case vc::pcb::StopReason::Timeout:
+                exitCode = ExitBudget;
+                vc::log::error("Budget exhausted");
+                break;
+            default:
+                exitCode = ExitHalted;
+                vc::log::error("All cores halted without finishing");
+                break;
+        }
+
+        for (auto cycles : runner.getCycleReports())
+            vc::log::info("Guest reported {} cycles", cycles);
+
+        vc::log::info("{} instructions in {:.3f} s, {:.2f} MIPS", result.instructions, seconds, result.instructions / seconds / 1'000'000);
+
+        if (profiler.has_value()) {
+            vc::debug::SymbolTable symbols;
+            if (!symbols.loadELF(options.elfPaths.front()))
+                vc::log::warn("Failed to read symbols from '{}', the profile only contains addresses", options.elfPaths.front());
+
+            vc::log::info("Took {} profile samples", profiler->getSampleCount());
+
+            if (options.profilePath.has_value() && !writeProfile(*profiler, symbols, *options.profilePath, false))
+                return ExitUsage;
+            if (options.flatProfilePath.has_value() && !writeProfile(*profiler, symbols, *options.flatProfilePath, true))
+                return ExitUsage;
+        }
+
+        return exitCode;
+    }
+
+    int runFleet(const Options &options) {
+        const auto boardCount = u32(options.elfPaths.size()) * options.copies;
+
+        /* Every firmware gets loaded only once, all boards running it map the same memory images and only copy the pages they write to */
+        std::vector<vc::pcb::Snapshot> firmware;
+        for (auto path : options.elfPaths) {
+            vc::pcb::HeadlessBoard board;
+            if (!loadFirmware(board, path))
+                return ExitUsage;
+
+            board.reset();
+            firmware.push_back(board.snapshot());
+        }
+
+        vc::pcb::Fleet fleet(boardCount, [&](u32 index) -> std::unique_ptr<vc::pcb::Board> {
+            auto board = std::make_unique<vc::pcb::HeadlessBoard>();
+            if (!board->restore(firmware[index / options.copies]))
+                return nullptr;
+
+            return board;
+        });
+
+        fleet.setWorkerCount(options.workers.value_or(0));
+        if (options.maxInstructions.has_value())
+            fleet.setInstructionLimit(*options.maxInstructions);
+        if (options.sliceInstructions.has_value())
+            fleet.setSliceInstructions(*options.sliceInstructions);
+        if (options.timeout.has_value())
+            fleet.setTimeout(toDuration(*options.timeout));
+
+        const auto report = fleet.run();
+
+        if (options.reportPath.has_value()) {
+            FILE *file = fopen(std::string(*options.reportPath).c_str(), "wb");
+            if (file == nullptr) {
+                vc::log::error("Failed to open '{}' for writing", *options.reportPath);
+                return ExitUsage;
+            }
+
+            fmt::print(file, "{{\n  \"seconds\": {:.6f},\n  \"instructions\": {},\n  \"boards\": [\n", report.seconds, report.getTotalInstructions());
+            for (u32 i = 0; i < report.boards.size(); i++) {
+                const auto &board = report.boards[i];
+
+                fmt::print(file, "    {{ \"index\": {}, \"firmware\": \"{}\", \"result\": \"{}\", \"exit_code\": {}, \"instructions\": {}, \"cycles\": [{}], \"output\": \"{}\" }}{}\n",
+                    i, escapeJson(options.elfPaths[i / options.copies]), board.created ? getReasonName(board.reason) : "not_created",
+                    board.exitCode.has_value() ? std::to_string(*board.exitCode) : "null",
+                    board.instructions, fmt::join(board.cycleReports, ", "), escapeJson(board.output), i + 1 < report.boards.size() ? "," : "");
+            }
+            fmt::print(file, "  ]\n}}\n");
+
+            fclose(file);
+        }
+
+        const auto passed = report.getPassedCount();
+        const auto finished = report.getCount(vc::pcb::StopReason::Finished);
+        const auto budget = report.getCount(vc::pcb::StopReason::InstructionLimit) + report.getCount(vc::pcb::StopReason::Timeout);
+        const auto notCreated = report.getNotCreatedCount();
+
+        vc::log::info("{} boards: {} passed, {} failed, {} ran out of budget, {} halted, {} couldn't be created", boardCount, passed, finished - passed, budget, boardCount - finished - budget - notCreated, notCreated);
+        vc::log::info("{} instructions in {:.3f} s, {:.2f} MIPS, {} steals", report.getTotalInstructions(), report.seconds, report.getTotalInstructions() / report.seconds / 1'000'000, report.steals);
+
+        return passed == boardCount ? 0 : 1;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--uart" && hasValue)
+                options.uartPath = argv[++i];
+            else if (argument == "--report" && hasValue)
+                options.reportPath = argv[++i];
+            else if (argument == "--profile" && hasValue)
+                options.profilePath = argv[++i];
+            else if (argument == "--profile-flat" && hasValue)
+                options.flatProfilePath = argv[++i];
+            else if (argument == "--profile-interval" && hasValue)
+                options.profileInterval = std::max(1UL, std::stoul(argv[++i]));
+            else if (argument == "--max-instructions" && hasValue)
+                options.maxInstructions = std::stoull(argv[++i], nullptr, 0);
+            else if (argument == "--slice" && hasValue)
+                options.sliceInstructions = std::stoull(argv[++i], nullptr, 0);
+            else if (argument == "--timeout" && hasValue)
+                options.timeout = std::stod(argv[++i]);
+            else if (argument == "--workers" && hasValue)
+                options.workers = std::stoul(argv[++i]);
+            else if (argument == "--copies" && hasValue)
+                options.copies = std::max(1UL, std::stoul(argv[++i]));
+            else if (!argument.starts_with("--"))
+                options.elfPaths.push_back(argument);
+            else {
+                printUsage(argv[0]);
+                return ExitUsage;
+            }
+        } catch (const std::logic_error&) {
+            printUsage(argv[0]);
+            return ExitUsage;
+        }
+    }
+
+    if (options.elfPaths.empty()) {
+        printUsage(argv[0]);
+        return ExitUsage;
+    }
+
+    if (options.elfPaths.size() * options.copies > 1) {
+        if (options.uartPath.has_value() || options.profilePath.has_value() || options.flatProfilePath.has_value()) {
+            vc::log::error("--uart, --profile and --profile-flat only work with a single board");
+            printUsage(argv[0]);
+            return ExitUsage;
+        }
+
+        return runFleet(options);
+    }
+    else
+        return runSingle(options);
+}
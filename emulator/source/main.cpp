@@ -1,16 +1,69 @@
 #include <board/board_test.hpp>
+#include <debug/gdb_server.hpp>
+#include <debug/time_machine.hpp>
 #include <ui/window.hpp>
 
 #include <ui/views/view_control.hpp>
 #include <ui/views/view_pcb.hpp>
+#include <ui/views/view_performance.hpp>
+#include <ui/views/view_memory.hpp>
+#include <ui/views/view_disassembly.hpp>
 
-int main() {
-    vc::ui::Window window;
+#include <charconv>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+
+int main(int argc, char **argv) {
     vc::pcb::TestBoard board;
 
+    /* --gdb <port> or --gdb unix:<path> starts a GDB server for the board's CPU, with reverse execution support */
+    std::unique_ptr<vc::debug::TimeMachine> timeMachine;
+    std::unique_ptr<vc::debug::GDBServer> gdbServer;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) != "--gdb")
+            continue;
+
+        if (i + 1 >= argc) {
+            vc::log::error("--gdb needs a port or unix:<path> to listen on");
+            return EXIT_FAILURE;
+        }
+        if (gdbServer != nullptr) {
+            vc::log::error("--gdb may only be given once");
+            return EXIT_FAILURE;
+        }
+
+        std::string_view target = argv[++i];
+        timeMachine = std::make_unique<vc::debug::TimeMachine>(board, board.cpu);
+        gdbServer = std::make_unique<vc::debug::GDBServer>(board, board.cpu);
+        gdbServer->setTimeMachine(timeMachine.get());
+
+        bool listening;
+        if (target.starts_with("unix:")) {
+            listening = gdbServer->listenUnix(target.substr(5));
+        } else {
+            u16 port = 0;
+            auto [end, error] = std::from_chars(target.data(), target.data() + target.size(), port);
+            if (error != std::errc() || end != target.data() + target.size() || port == 0) {
+                vc::log::error("Invalid GDB port '{}'", target);
+                return EXIT_FAILURE;
+            }
+
+            listening = gdbServer->listenTcp(port);
+        }
+
+        /* The server already logged why it couldn't listen */
+        if (!listening)
+            return EXIT_FAILURE;
+    }
+
+    vc::ui::Window window;
 
     window.addView<vc::ui::ViewControl>(board);
     window.addView<vc::ui::ViewPCB>(board);
+    window.addView<vc::ui::ViewPerformance>(board, window);
+    window.addView<vc::ui::ViewMemory>(board);
+    window.addView<vc::ui::ViewDisassembly>(board);
 
     window.loop();
-}
\ No newline at end of file
+}
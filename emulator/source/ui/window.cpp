@@ -1,5 +1,6 @@
 #include <ui/window.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 #include <thread>
@@ -11,6 +12,7 @@
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_internal.h>
+#include <implot.h>
 #include <fontawesome_font.h>
 
 #include <imgui_impl_opengl3.h>
@@ -37,15 +39,28 @@ namespace vc::ui {
             if (!glfwGetWindowAttrib(this->windowHandle, GLFW_VISIBLE) || glfwGetWindowAttrib(this->windowHandle, GLFW_ICONIFIED))
                 glfwWaitEvents();
 
+            /* Sleep until input arrives or one of the views has something new to show */
+            while (this->pendingFrames == 0 && !this->viewsNeedRedraw() && !glfwWindowShouldClose(this->windowHandle))
+                glfwWaitEventsTimeout(1.0 / this->targetFps);
+
             glfwPollEvents();
 
             this->frameBegin();
             this->frame();
             this->frameEnd();
+
+            if (this->pendingFrames > 0)
+                this->pendingFrames--;
         }
     }
 
+    bool Window::viewsNeedRedraw() const {
+        return std::any_of(this->views.begin(), this->views.end(), [](View *view) { return view->needsRedraw(); });
+    }
+
     void Window::frameBegin() {
+        this->frameStartTime = glfwGetTime();
+
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -103,7 +118,11 @@ namespace vc::ui {
 
         glfwSwapBuffers(this->windowHandle);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(u64((this->lastFrameTime + 1 / (ImGui::IsWindowFocused(ImGuiFocusedFlags_AnyWindow) ? this->targetFps : 5.0) - glfwGetTime()) * 1000)));
+        this->frameDuration = glfwGetTime() - this->frameStartTime;
+
+        auto remainingFrameTime = this->lastFrameTime + 1 / (ImGui::IsWindowFocused(ImGuiFocusedFlags_AnyWindow) ? this->targetFps : 5.0) - glfwGetTime();
+        if (remainingFrameTime > 0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(remainingFrameTime));
         this->lastFrameTime = glfwGetTime();
     }
 
@@ -154,7 +173,37 @@ namespace vc::ui {
             win->frameEnd();
         });
 
+        /* Any kind of input invalidates the current frame. ImGui chains its own mouse, scroll, key and char callbacks to these */
+        glfwSetCursorPosCallback(this->windowHandle, [](GLFWwindow *window, double, double) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetCursorEnterCallback(this->windowHandle, [](GLFWwindow *window, int) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetMouseButtonCallback(this->windowHandle, [](GLFWwindow *window, int, int, int) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetScrollCallback(this->windowHandle, [](GLFWwindow *window, double, double) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetCharCallback(this->windowHandle, [](GLFWwindow *window, unsigned int) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetWindowFocusCallback(this->windowHandle, [](GLFWwindow *window, int) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
+        glfwSetWindowRefreshCallback(this->windowHandle, [](GLFWwindow *window) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
+        });
+
         glfwSetKeyCallback(this->windowHandle, [](GLFWwindow *window, int key, int scancode, int action, int mods) {
+            static_cast<Window*>(glfwGetWindowUserPointer(window))->markDirty();
 
             auto keyName = glfwGetKeyName(key, scancode);
             if (keyName != nullptr)
@@ -186,6 +235,7 @@ namespace vc::ui {
         IMGUI_CHECKVERSION();
 
         GImGui = ImGui::CreateContext();
+        ImPlot::CreateContext();
 
         ImGuiIO& io = ImGui::GetIO();
         ImGuiStyle& style = ImGui::GetStyle();
@@ -264,6 +314,7 @@ namespace vc::ui {
     void Window::deinitImGui() {
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
+        ImPlot::DestroyContext();
         ImGui::DestroyContext();
     }
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <types.hpp>
+
+/*
+ * Minimal runtime for the benchmark kernels. Runs on the emulator's headless board, which next to the test board's
+ * memory map has a test finisher to end the run and a cycle counter to measure with
+ */
+namespace rt {
+
+    inline volatile u32 *const FINISHER     = reinterpret_cast<volatile u32*>(0x0010'0000);
+    inline volatile u64 *const CYCLE        = reinterpret_cast<volatile u64*>(0x0010'1000);
+    inline volatile u64 *const REPORT       = reinterpret_cast<volatile u64*>(0x0010'1008);
+
+    inline volatile char *const UARTA_TX    = reinterpret_cast<volatile char*>(0x5000'0004);
+
+    inline volatile u8 *const GPIOA_CR      = reinterpret_cast<volatile u8*>(0x6000'0000);
+    inline volatile u8 *const GPIOA_IN      = reinterpret_cast<volatile u8*>(0x6000'0004);
+    inline volatile u8 *const GPIOA_OUT     = reinterpret_cast<volatile u8*>(0x6000'0008);
+
+    void print(const char *string);
+    void printNumber(u64 number);
+
+    /* Ends the run, the emulator exits with the given code */
+    [[noreturn]]
+    void exit(u32 code);
+
+    /* Cycles the core has spent since it got reset */
+    inline u64 cycles() {
+        return *CYCLE;
+    }
+
+    /* Hands a result over to the emulator and prints it */
+    inline void report(const char *name, u64 cycles) {
+        *REPORT = cycles;
+
+        print(name);
+        print(": ");
+        printNumber(cycles);
+        print(" cycles\n");
+    }
+
+    /* Runs the function once and reports the cycles it took */
+    template<typename F>
+    u64 measure(const char *name, F &&function) {
+        const auto start = cycles();
+        function();
+        const auto end = cycles();
+
+        report(name, end - start);
+        return end - start;
+    }
+
+    /* Fails the run if the condition doesn't hold, every kernel checks its own results */
+    inline void check(bool condition, const char *message) {
+        if (condition) return;
+
+        print("Check failed: ");
+        print(message);
+        print("\n");
+        exit(1);
+    }
+
+}
@@ -0,0 +1,6 @@
+[[gnu::section(".crt0")]]
+[[gnu::naked]]
+extern "C" void _start() {
+    asm("lui sp, 0x10020");
+    asm("tail main");
+}
@@ -0,0 +1,29 @@
+#include <runtime.hpp>
+
+/*
+ * Toggles a GPIO-A output as fast as possible while reading back the inputs, like bit banging firmware does
+ */
+
+namespace {
+
+    constexpr u32 Toggles = 10'000;
+
+}
+
+int main() {
+    *rt::GPIOA_CR = 0b10;
+
+    u32 inputs = 0;
+    rt::measure("gpio_toggle", [&] {
+        for (u32 i = 0; i < Toggles; i++) {
+            *rt::GPIOA_OUT = (i & 1) << 1;
+            inputs += *rt::GPIOA_IN & 0b01;
+        }
+    });
+
+    rt::print("inputs seen: ");
+    rt::printNumber(inputs);
+    rt::print("\n");
+
+    rt::exit(0);
+}
@@ -0,0 +1,175 @@
+#include <runtime.hpp>
+
+/*
+ * Integer workload in the spirit of CoreMark: linked list processing, a small matrix multiplication,
+ * a state machine scanning text and a CRC over all of their results
+ */
+
+namespace {
+
+    constexpr u32 Iterations = 10;
+
+    /* Linked list */
+
+    struct Node {
+        Node *next;
+        i32 value;
+    };
+
+    constexpr u32 ListSize = 64;
+    Node nodes[ListSize];
+
+    Node* buildList(u32 seed) {
+        for (u32 i = 0; i < ListSize; i++) {
+            nodes[i].value = i32((i * 7 + seed) % ListSize);
+            nodes[i].next = i + 1 < ListSize ? &nodes[i + 1] : nullptr;
+        }
+
+        return &nodes[0];
+    }
+
+    [[gnu::noinline]]
+    Node* reverse(Node *head) {
+        Node *previous = nullptr;
+        while (head != nullptr) {
+            auto next = head->next;
+            head->next = previous;
+            previous = head;
+            head = next;
+        }
+
+        return previous;
+    }
+
+    [[gnu::noinline]]
+    Node* find(Node *head, i32 value) {
+        for (; head != nullptr; head = head->next) {
+            if (head->value == value)
+                return head;
+        }
+
+        return nullptr;
+    }
+
+    u32 processList(u32 seed) {
+        auto head = reverse(reverse(buildList(seed)));
+
+        u32 found = 0;
+        for (i32 value = 0; value < i32(ListSize); value += 3) {
+            if (auto node = find(head, value); node != nullptr)
+                found += u32(node - nodes);
+        }
+
+        return found;
+    }
+
+    /* Matrix */
+
+    constexpr u32 MatrixSize = 8;
+    i32 matrixA[MatrixSize][MatrixSize], matrixB[MatrixSize][MatrixSize], matrixC[MatrixSize][MatrixSize];
+
+    u32 processMatrix(u32 seed) {
+        for (u32 y = 0; y < MatrixSize; y++) {
+            for (u32 x = 0; x < MatrixSize; x++) {
+                matrixA[y][x] = i32((x + y + seed) % 13) - 6;
+                matrixB[y][x] = i32((x * y + seed) % 11) - 5;
+            }
+        }
+
+        for (u32 y = 0; y < MatrixSize; y++) {
+            for (u32 x = 0; x < MatrixSize; x++) {
+                i32 sum = 0;
+                for (u32 i = 0; i < MatrixSize; i++)
+                    sum += matrixA[y][i] * matrixB[i][x];
+
+                matrixC[y][x] = sum;
+            }
+        }
+
+        u32 result = 0;
+        for (u32 y = 0; y < MatrixSize; y++) {
+            for (u32 x = 0; x < MatrixSize; x++)
+                result = result * 31 + u32(matrixC[y][x]);
+        }
+
+        return result;
+    }
+
+    /* State machine recognizing numbers in text */
+
+    enum class State { Start, Integer, Fraction, Invalid };
+
+    const char *Text = "12 7.5 abc 3.14.15 -2 880 0.001 x9 42";
+
+    u32 processText() {
+        u32 integers = 0, fractions = 0, invalid = 0;
+        State state = State::Start;
+
+        for (const char *c = Text; ; c++) {
+            if (*c == ' ' || *c == 0x00) {
+                switch (state) {
+                    case State::Integer:    integers++; break;
+                    case State::Fraction:   fractions++; break;
+                    case State::Invalid:    invalid++; break;
+                    default: break;
+                }
+
+                state = State::Start;
+                if (*c == 0x00) break;
+                continue;
+            }
+
+            const bool digit = *c >= '0' && *c <= '9';
+            switch (state) {
+                case State::Start:      state = digit ? State::Integer : State::Invalid; break;
+                case State::Integer:    state = digit ? State::Integer : (*c == '.' ? State::Fraction : State::Invalid); break;
+                case State::Fraction:   state = digit ? State::Fraction : State::Invalid; break;
+                case State::Invalid:    break;
+            }
+        }
+
+        return (integers << 16) | (fractions << 8) | invalid;
+    }
+
+    /* CRC-16/CCITT-FALSE */
+
+    u16 crc16(u16 crc, u8 data) {
+        crc ^= u16(data) << 8;
+        for (u32 bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) != 0 ? u16((crc << 1) ^ 0x1021) : u16(crc << 1);
+
+        return crc;
+    }
+
+    u16 crc16(u16 crc, u32 value) {
+        for (u32 i = 0; i < 4; i++)
+            crc = crc16(crc, u8(value >> (i * 8)));
+
+        return crc;
+    }
+
+}
+
+int main() {
+    u16 checkValue = 0xFFFF;
+    for (const char *c = "123456789"; *c != 0x00; c++)
+        checkValue = crc16(checkValue, u8(*c));
+    rt::check(checkValue == 0x29B1, "CRC check value");
+
+    rt::check(processText() == ((3 << 16) | (2 << 8) | 4), "State machine counts");
+
+    u16 crc = 0xFFFF;
+    rt::measure("integer", [&] {
+        for (u32 i = 0; i < Iterations; i++) {
+            crc = crc16(crc, processList(i));
+            crc = crc16(crc, processMatrix(i));
+            crc = crc16(crc, processText());
+        }
+    });
+
+    rt::print("crc: ");
+    rt::printNumber(crc);
+    rt::print("\n");
+
+    rt::exit(0);
+}
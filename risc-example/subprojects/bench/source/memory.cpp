@@ -0,0 +1,56 @@
+#include <runtime.hpp>
+
+/*
+ * Memory bandwidth through the runtime's memset and memcpy, once with aligned buffers taking the double word path and once misaligned falling back to bytes
+ */
+
+extern "C" void* memcpy(void *destination, const void *source, unsigned long size);
+extern "C" void* memset(void *destination, int value, unsigned long size);
+
+namespace {
+
+    constexpr u32 BufferSize = 16 * 1024;
+    constexpr u32 Iterations = 4;
+
+    alignas(8) u8 source[BufferSize];
+    alignas(8) u8 destination[BufferSize];
+
+    void reportBandwidth(const char *name, u64 bytes, u64 cycles) {
+        rt::print(name);
+        rt::print(": ");
+        rt::printNumber(bytes * 100 / (cycles != 0 ? cycles : 1));
+        rt::print(" bytes per 100 cycles\n");
+    }
+
+}
+
+int main() {
+    const auto setCycles = rt::measure("memset", [] {
+        for (u32 i = 0; i < Iterations; i++)
+            memset(source, i32(0xA5 + i), BufferSize);
+    });
+    reportBandwidth("memset", u64(BufferSize) * Iterations, setCycles);
+
+    for (u32 i = 0; i < BufferSize; i++)
+        source[i] = u8(i * 13);
+
+    const auto copyCycles = rt::measure("memcpy", [] {
+        for (u32 i = 0; i < Iterations; i++)
+            memcpy(destination, source, BufferSize);
+    });
+    reportBandwidth("memcpy", u64(BufferSize) * Iterations, copyCycles);
+
+    for (u32 i = 0; i < BufferSize; i++)
+        rt::check(destination[i] == u8(i * 13), "Aligned copy");
+
+    const auto unalignedCycles = rt::measure("memcpy_unaligned", [] {
+        for (u32 i = 0; i < Iterations; i++)
+            memcpy(destination + 1, source, BufferSize - 1);
+    });
+    reportBandwidth("memcpy_unaligned", u64(BufferSize - 1) * Iterations, unalignedCycles);
+
+    for (u32 i = 0; i < BufferSize - 1; i++)
+        rt::check(destination[i + 1] == u8(i * 13), "Unaligned copy");
+
+    rt::exit(0);
+}
@@ -0,0 +1,57 @@
+#include <runtime.hpp>
+
+/*
+ * Function call heavy workload. Deep chains of calls and returns that exercise the stack and JAL/JALR
+ */
+
+namespace {
+
+    [[gnu::noinline]]
+    u64 fibonacci(u64 n) {
+        if (n < 2)
+            return n;
+
+        return fibonacci(n - 1) + fibonacci(n - 2);
+    }
+
+    [[gnu::noinline]]
+    u64 ackermann(u64 m, u64 n) {
+        if (m == 0)
+            return n + 1;
+        if (n == 0)
+            return ackermann(m - 1, 1);
+
+        return ackermann(m - 1, ackermann(m, n - 1));
+    }
+
+    /* Mutual recursion through a function pointer, so the calls can't be turned into jumps */
+    [[gnu::noinline]] bool isOdd(u32 n);
+
+    [[gnu::noinline]]
+    bool isEven(u32 n) {
+        return n == 0 ? true : isOdd(n - 1);
+    }
+
+    bool (*volatile evenCheck)(u32) = isEven;
+
+    [[gnu::noinline]]
+    bool isOdd(u32 n) {
+        return n == 0 ? false : evenCheck(n - 1);
+    }
+
+}
+
+int main() {
+    u64 fib = 0, ack = 0;
+    bool even = false;
+
+    rt::measure("fibonacci", [&] { fib = fibonacci(20); });
+    rt::measure("ackermann", [&] { ack = ackermann(2, 3); });
+    rt::measure("mutual", [&] { even = isEven(1000); });
+
+    rt::check(fib == 6765, "fibonacci(20)");
+    rt::check(ack == 9, "ackermann(2, 3)");
+    rt::check(even, "isEven(1000)");
+
+    rt::exit(0);
+}
@@ -0,0 +1,61 @@
+#include <runtime.hpp>
+
+namespace rt {
+
+    void print(const char *string) {
+        for (const char *s = string; *s != 0x00; s++)
+            *UARTA_TX = *s;
+    }
+
+    void printNumber(u64 number) {
+        char buffer[21] = { };
+        u32 position = sizeof(buffer) - 1;
+
+        do {
+            buffer[--position] = '0' + number % 10;
+            number /= 10;
+        } while (number != 0);
+
+        print(buffer + position);
+    }
+
+    void exit(u32 code) {
+        *FINISHER = code == 0 ? 0x5555 : (code << 16) | 0x3333;
+
+        /* An empty endless loop is undefined behaviour in C++ and gets dropped, exit would fall through into whatever comes next */
+        while (true)
+            asm volatile("");
+    }
+
+}
+
+/* There's no libc, the compiler still expects these to exist for copies and clears it generates on its own */
+extern "C" void* memcpy(void *destination, const void *source, unsigned long size) {
+    auto dst = static_cast<u8*>(destination);
+    auto src = static_cast<const u8*>(source);
+
+    if (((reinterpret_cast<u64>(dst) | reinterpret_cast<u64>(src)) & 0b111) == 0) {
+        for (; size >= sizeof(u64); size -= sizeof(u64), dst += sizeof(u64), src += sizeof(u64))
+            *reinterpret_cast<u64*>(dst) = *reinterpret_cast<const u64*>(src);
+    }
+
+    while (size-- > 0)
+        *dst++ = *src++;
+
+    return destination;
+}
+
+extern "C" void* memset(void *destination, int value, unsigned long size) {
+    auto dst = static_cast<u8*>(destination);
+
+    if ((reinterpret_cast<u64>(dst) & 0b111) == 0) {
+        const u64 pattern = u8(value) * 0x0101'0101'0101'0101UL;
+        for (; size >= sizeof(u64); size -= sizeof(u64), dst += sizeof(u64))
+            *reinterpret_cast<u64*>(dst) = pattern;
+    }
+
+    while (size-- > 0)
+        *dst++ = u8(value);
+
+    return destination;
+}
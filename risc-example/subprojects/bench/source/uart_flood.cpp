@@ -0,0 +1,31 @@
+#include <runtime.hpp>
+
+/*
+ * Pushes as many bytes through UART-A as possible. Every byte crosses the board's track to whatever is listening on the other end
+ */
+
+namespace {
+
+    constexpr u32 Lines = 64;
+    const char *Line = "The quick brown fox jumps over the lazy dog 0123456789\n";
+
+}
+
+int main() {
+    u64 bytes = 0;
+    for (const char *c = Line; *c != 0x00; c++)
+        bytes++;
+
+    const auto cycles = rt::measure("uart_flood", [] {
+        for (u32 i = 0; i < Lines; i++) {
+            for (const char *c = Line; *c != 0x00; c++)
+                *rt::UARTA_TX = *c;
+        }
+    });
+
+    rt::print("uart_flood: ");
+    rt::printNumber(bytes * Lines * 100 / (cycles != 0 ? cycles : 1));
+    rt::print(" bytes per 100 cycles\n");
+
+    rt::exit(0);
+}